@@ -0,0 +1,173 @@
+/**************************************************************************/
+/**
+ *
+ * @file CowPi.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Host-side stand-in for the parts of the CowPi library that the
+ *      combination lock uses.
+ *
+ * Inputs are read from <code>mock_cowpi_inputs</code>, which a host program
+ * sets to whatever the buttons, switches, and keypad should report; outputs
+ * are written to <code>mock_cowpi_outputs</code>. The memory-mapped registers
+ * that the lock accesses directly are ordinary variables here, and
+ * <code>memory-map.h</code> is pointed at them.
+ *
+ * The free-running timer reports a virtual time that advances only when the
+ * host program advances it. <code>mock_advance_time_us()</code> and
+ * <code>mock_run_until_us()</code> fire the ISRs registered with
+ * <code>register_periodic_timer_ISR()</code> at their due times along the way,
+ * and <code>mock_set_input_pins()</code> fires the ISRs registered with
+ * <code>register_pin_ISR()</code> for the pins that change. ISRs fire only
+ * while <code>mock_interrupts_enabled</code> is set, and only the ISRs
+ * registered with <code>register_flash_safe_timer_ISR()</code> fire during a
+ * flash stall.
+ *
+ * Because nothing else advances the virtual time, code that busy-waits on the
+ * timer or on an ISR never returns on the host.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COWPI_MOCK_H
+#define COWPI_MOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// laid out like the RP2040's single-cycle I/O block
+typedef struct {
+    uint32_t cpuid;
+    uint32_t input;
+    uint32_t input_hi;
+    uint32_t reserved;
+    uint32_t output;
+    uint32_t output_set;
+    uint32_t output_clear;
+    uint32_t output_toggle;
+} cowpi_ioport_t;
+
+// laid out like the RP2040's timer
+typedef struct {
+    uint32_t write_upper_word;
+    uint32_t write_lower_word;
+    uint32_t read_upper_word;
+    uint32_t read_lower_word;
+    uint32_t alarm[4];
+    uint32_t armed;
+    uint32_t raw_upper_word;
+    uint32_t raw_lower_word;
+} cowpi_timer_t;
+
+extern cowpi_ioport_t volatile mock_sio;
+extern cowpi_timer_t volatile mock_timer;
+// laid out like the Cortex-M0+ SysTick: control and status, reload value, current value, calibration
+extern uint32_t volatile mock_systick[4];
+
+#define SIO_BASE_ADDRESS (&mock_sio)
+#define TIMER_BASE_ADDRESS (&mock_timer)
+#define SYSTICK_BASE_ADDRESS (mock_systick)
+
+struct mock_cowpi_inputs {
+    bool left_button_pressed;
+    bool right_button_pressed;
+    bool left_switch_in_right_position;
+    bool right_switch_in_right_position;
+    char key;                               // '\0' if no key is pressed
+};
+
+struct mock_cowpi_outputs {
+    bool left_led_on;
+    bool right_led_on;
+    uint32_t output_pins;
+    uint32_t pullup_input_pins;
+};
+
+extern struct mock_cowpi_inputs mock_cowpi_inputs;
+extern struct mock_cowpi_outputs mock_cowpi_outputs;
+
+/**
+ * Returns the inputs, outputs, registers, clocks, display, and virtual time to
+ * their power-on state: buttons released, switches left, no key pressed, LEDs
+ * off, display blank, no ISRs registered, time 0.
+ */
+void mock_cowpi_reset(void);
+
+/**
+ * Sets the virtual time reported by the free-running timer without firing
+ * any timer ISRs.
+ *
+ * @param time_us The number of microseconds since virtual power-on
+ */
+void mock_set_time_us(uint64_t time_us);
+
+uint64_t mock_time_us(void);
+
+/**
+ * Advances the virtual time by <code>duration_us</code>, firing each periodic
+ * timer ISR whenever it comes due, in chronological order.
+ *
+ * @param duration_us The number of microseconds to advance
+ */
+void mock_advance_time_us(uint64_t duration_us);
+
+/**
+ * Advances the virtual time to <code>time_us</code>, firing each periodic
+ * timer ISR whenever it comes due. Does nothing if that time has passed.
+ *
+ * @param time_us The number of microseconds since virtual power-on
+ */
+void mock_run_until_us(uint64_t time_us);
+
+/**
+ * Drives the input pins selected by <code>pin_mask</code> to the levels in
+ * <code>levels</code>, then fires the pin ISR of each pin whose level changed,
+ * lowest pin first.
+ *
+ * @param levels A bit vector of pin levels: Bit0 for Pin 0, and so on
+ * @param pin_mask A bit vector of the pins to be driven
+ */
+void mock_set_input_pins(uint32_t levels, uint32_t pin_mask);
+
+/**
+ * Forgets every registered pin and timer ISR.
+ */
+void mock_clear_ISRs(void);
+
+// what display_string() last wrote to each row of the display
+#define MOCK_DISPLAY_ROWS (8)
+#define MOCK_DISPLAY_COLUMNS (21)
+extern char mock_display_rows[MOCK_DISPLAY_ROWS][MOCK_DISPLAY_COLUMNS + 1];
+
+bool cowpi_left_button_is_pressed(void);
+bool cowpi_right_button_is_pressed(void);
+bool cowpi_left_switch_is_in_left_position(void);
+bool cowpi_left_switch_is_in_right_position(void);
+bool cowpi_right_switch_is_in_left_position(void);
+bool cowpi_right_switch_is_in_right_position(void);
+void cowpi_illuminate_left_led(void);
+void cowpi_deluminate_left_led(void);
+void cowpi_illuminate_right_led(void);
+void cowpi_deluminate_right_led(void);
+char cowpi_get_keypress(void);
+void cowpi_set_output_pins(uint32_t pin_mask);
+void cowpi_set_pullup_input_pins(uint32_t pin_mask);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COWPI_MOCK_H
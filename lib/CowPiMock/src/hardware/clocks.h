@@ -0,0 +1,68 @@
+/**************************************************************************/
+/**
+ *
+ * @file hardware/clocks.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Host-side stand-in for the Pico SDK's clock functions, which records
+ *      the frequencies that the code under test asks for.
+ *
+ * The system clock can be set anywhere from
+ * <code>MOCK_MINIMUM_SYS_CLOCK_kHZ</code> to
+ * <code>MOCK_MAXIMUM_SYS_CLOCK_kHZ</code>; the PLL cannot make anything
+ * outside that range, so <code>set_sys_clock_khz()</code> refuses it. Neither
+ * the virtual time nor the timer ISRs depend on the frequency, just as the
+ * RP2040's timer does not.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COWPI_MOCK_HARDWARE_CLOCKS_H
+#define COWPI_MOCK_HARDWARE_CLOCKS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KHZ (1000u)
+#define MHZ (1000000u)
+
+#define MOCK_MINIMUM_SYS_CLOCK_kHZ (16000)
+#define MOCK_MAXIMUM_SYS_CLOCK_kHZ (133000)
+
+enum clock_index {
+    clk_gpout0, clk_gpout1, clk_gpout2, clk_gpout3,
+    clk_ref, clk_sys, clk_peri, clk_usb, clk_adc, clk_rtc,
+    CLK_COUNT
+};
+
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS (0x0)
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB (0x2)
+
+extern uint32_t mock_clock_hz[CLK_COUNT];
+extern uint32_t mock_sys_clock_changes;
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq);
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+/**
+ * Returns the clocks to their state after the SDK's runtime initialization:
+ * clk_sys and clk_peri at 125 MHz, clk_usb at 48 MHz, and clk_ref at 12 MHz.
+ */
+void mock_reset_clocks(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COWPI_MOCK_HARDWARE_CLOCKS_H
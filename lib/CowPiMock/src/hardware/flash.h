@@ -0,0 +1,62 @@
+/**************************************************************************/
+/**
+ *
+ * @file hardware/flash.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Host-side stand-in for the Pico SDK's flash functions, backed by an
+ *      array that behaves like NOR flash: erasing sets bytes to
+ *      <code>0xFF</code>, and programming can only clear bits.
+ *
+ * Erasing and programming also advance the virtual time by the flash chip's
+ * typical durations, because the processor stalls for that long on the board.
+ * Flash-safe timer ISRs fire during the stall, on time. Other timer ISRs that
+ * come due during a stall begun with <code>begin_flash_stall()</code> fire
+ * once it has ended, as interrupts left pending would.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COWPI_MOCK_HARDWARE_FLASH_H
+#define COWPI_MOCK_HARDWARE_FLASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+// typical for the Pico's W25Q16JV
+#define MOCK_FLASH_SECTOR_ERASE_uS (45000)
+#define MOCK_FLASH_PAGE_PROGRAM_uS (400)
+
+extern uint8_t mock_flash[PICO_FLASH_SIZE_BYTES];
+
+#define XIP_BASE ((uintptr_t) mock_flash)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, uint8_t const *data, size_t count);
+
+/**
+ * Erases the whole mock flash, as on a new board.
+ */
+void mock_flash_erase_all(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COWPI_MOCK_HARDWARE_FLASH_H
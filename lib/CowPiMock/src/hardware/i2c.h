@@ -0,0 +1,60 @@
+/**************************************************************************/
+/**
+ *
+ * @file hardware/i2c.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Host-side stand-in for the Pico SDK's I2C baud rate setting, which
+ *      records the rate that the bus actually runs at.
+ *
+ * As on the RP2040, an I2C block counts out its clock in cycles of the system
+ * clock, and those counts are worked out when the baud rate is set. A later
+ * change of the system clock therefore scales the bus's rate with it until the
+ * baud rate is set again, as <code>mock_i2c_scl_hz()</code> reports.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COWPI_MOCK_HARDWARE_I2C_H
+#define COWPI_MOCK_HARDWARE_I2C_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t baud_hz;               // the rate asked for
+    uint32_t sys_clock_hz;          // clk_sys when it was asked for
+} i2c_inst_t;
+
+extern i2c_inst_t mock_i2c[2];
+
+#define i2c0 (&mock_i2c[0])
+#define i2c1 (&mock_i2c[1])
+
+uint32_t i2c_set_baudrate(i2c_inst_t *i2c, uint32_t baudrate);
+
+/**
+ * @return The rate that the bus runs at with the current system clock, or 0 if
+ *      its baud rate has not been set
+ */
+uint32_t mock_i2c_scl_hz(i2c_inst_t const *i2c);
+
+/**
+ * Forgets the baud rates.
+ */
+void mock_reset_i2c(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COWPI_MOCK_HARDWARE_I2C_H
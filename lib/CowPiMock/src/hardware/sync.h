@@ -0,0 +1,47 @@
+/**************************************************************************/
+/**
+ *
+ * @file hardware/sync.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Host-side stand-in for the Pico SDK's interrupt masking.
+ *
+ * The host has no interrupts of its own; the flag only records whether the
+ * code under test currently expects interrupts to be able to fire.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COWPI_MOCK_HARDWARE_SYNC_H
+#define COWPI_MOCK_HARDWARE_SYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern bool mock_interrupts_enabled;
+
+static inline uint32_t save_and_disable_interrupts(void) {
+    uint32_t status = mock_interrupts_enabled;
+    mock_interrupts_enabled = false;
+    return status;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+    mock_interrupts_enabled = (bool) status;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COWPI_MOCK_HARDWARE_SYNC_H
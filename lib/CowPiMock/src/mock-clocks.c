@@ -0,0 +1,52 @@
+/**************************************************************************/
+/**
+ *
+ * @file mock-clocks.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief hardware/clocks.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include "CowPi.h"
+#include "hardware/clocks.h"
+
+uint32_t mock_clock_hz[CLK_COUNT];
+uint32_t mock_sys_clock_changes;
+
+void mock_reset_clocks(void) {
+    memset(mock_clock_hz, 0, sizeof(mock_clock_hz));
+    mock_clock_hz[clk_ref] = 12 * MHZ;
+    mock_clock_hz[clk_sys] = 125 * MHZ;
+    mock_clock_hz[clk_peri] = 125 * MHZ;
+    mock_clock_hz[clk_usb] = 48 * MHZ;
+    mock_sys_clock_changes = 0;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    if (freq_khz < MOCK_MINIMUM_SYS_CLOCK_kHZ || freq_khz > MOCK_MAXIMUM_SYS_CLOCK_kHZ) {
+        return false;
+    }
+    mock_clock_hz[clk_sys] = freq_khz * KHZ;
+    mock_sys_clock_changes++;
+    return true;
+}
+
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq) {
+    if (clk_index >= CLK_COUNT || freq > src_freq) {
+        return false;
+    }
+    mock_clock_hz[clk_index] = freq;
+    return true;
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return (clk_index < CLK_COUNT) ? mock_clock_hz[clk_index] : 0;
+}
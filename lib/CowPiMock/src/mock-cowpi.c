@@ -0,0 +1,106 @@
+/**************************************************************************/
+/**
+ *
+ * @file mock-cowpi.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief CowPi.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include "CowPi.h"
+#include "hardware/clocks.h"
+#include "hardware/i2c.h"
+
+cowpi_ioport_t volatile mock_sio;
+cowpi_timer_t volatile mock_timer;
+uint32_t volatile mock_systick[4];
+
+struct mock_cowpi_inputs mock_cowpi_inputs;
+struct mock_cowpi_outputs mock_cowpi_outputs;
+
+static uint64_t virtual_time_us;
+
+void mock_cowpi_reset(void) {
+    memset(&mock_cowpi_inputs, 0, sizeof(mock_cowpi_inputs));
+    memset(&mock_cowpi_outputs, 0, sizeof(mock_cowpi_outputs));
+    memset((void *) &mock_sio, 0, sizeof(mock_sio));
+    memset((void *) &mock_timer, 0, sizeof(mock_timer));
+    memset((void *) mock_systick, 0, sizeof(mock_systick));
+    mock_reset_clocks();
+    mock_reset_i2c();
+    memset(mock_display_rows, 0, sizeof(mock_display_rows));
+    mock_clear_ISRs();
+    mock_set_time_us(0);
+}
+
+void mock_set_time_us(uint64_t time_us) {
+    virtual_time_us = time_us;
+    mock_timer.raw_upper_word = (uint32_t) (time_us >> 32);
+    mock_timer.raw_lower_word = (uint32_t) time_us;
+}
+
+uint64_t mock_time_us(void) {
+    return virtual_time_us;
+}
+
+bool cowpi_left_button_is_pressed(void) {
+    return mock_cowpi_inputs.left_button_pressed;
+}
+
+bool cowpi_right_button_is_pressed(void) {
+    return mock_cowpi_inputs.right_button_pressed;
+}
+
+bool cowpi_left_switch_is_in_left_position(void) {
+    return !mock_cowpi_inputs.left_switch_in_right_position;
+}
+
+bool cowpi_left_switch_is_in_right_position(void) {
+    return mock_cowpi_inputs.left_switch_in_right_position;
+}
+
+bool cowpi_right_switch_is_in_left_position(void) {
+    return !mock_cowpi_inputs.right_switch_in_right_position;
+}
+
+bool cowpi_right_switch_is_in_right_position(void) {
+    return mock_cowpi_inputs.right_switch_in_right_position;
+}
+
+void cowpi_illuminate_left_led(void) {
+    mock_cowpi_outputs.left_led_on = true;
+}
+
+void cowpi_deluminate_left_led(void) {
+    mock_cowpi_outputs.left_led_on = false;
+}
+
+void cowpi_illuminate_right_led(void) {
+    mock_cowpi_outputs.right_led_on = true;
+}
+
+void cowpi_deluminate_right_led(void) {
+    mock_cowpi_outputs.right_led_on = false;
+}
+
+char cowpi_get_keypress(void) {
+    return mock_cowpi_inputs.key;
+}
+
+void cowpi_set_output_pins(uint32_t pin_mask) {
+    mock_cowpi_outputs.output_pins |= pin_mask;
+}
+
+void cowpi_set_pullup_input_pins(uint32_t pin_mask) {
+    mock_cowpi_outputs.pullup_input_pins |= pin_mask;
+    // an unconnected pull-up input reads high
+    mock_sio.input |= pin_mask;
+}
@@ -0,0 +1,59 @@
+/**************************************************************************/
+/**
+ *
+ * @file mock-display.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Host-side stand-in for <code>display</code> that keeps the text of
+ *      each row instead of drawing it.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include "CowPi.h"
+
+char mock_display_rows[MOCK_DISPLAY_ROWS][MOCK_DISPLAY_COLUMNS + 1];
+
+// must match display.h, which lives with the sources under test
+void initialize_display(int number_of_columns);
+void clear_display(void);
+void draw_logo();
+void display_string(int row, char const string[]);
+void refresh_display(void);
+void print_versions(void);
+void record_build_timestamp(char const filename[], char const date[], char const time[]);
+void print_build_timestamps(bool only_most_recent);
+void count_visits(int row);
+
+void initialize_display(int number_of_columns) {
+    clear_display();
+}
+
+void clear_display(void) {
+    memset(mock_display_rows, 0, sizeof(mock_display_rows));
+}
+
+void draw_logo() {}
+
+void display_string(int row, char const string[]) {
+    if (row >= 0 && row < MOCK_DISPLAY_ROWS) {
+        strncpy(mock_display_rows[row], string, MOCK_DISPLAY_COLUMNS);
+        mock_display_rows[row][MOCK_DISPLAY_COLUMNS] = '\0';
+    }
+}
+
+void refresh_display(void) {}
+
+void print_versions(void) {}
+
+void record_build_timestamp(char const filename[], char const date[], char const time[]) {}
+
+void print_build_timestamps(bool only_most_recent) {}
+
+void count_visits(int row) {}
@@ -0,0 +1,43 @@
+/**************************************************************************/
+/**
+ *
+ * @file mock-flash.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief hardware/flash.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "CowPi.h"
+#include "hardware/flash.h"
+
+uint8_t mock_flash[PICO_FLASH_SIZE_BYTES];
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    assert(flash_offs % FLASH_SECTOR_SIZE == 0 && count % FLASH_SECTOR_SIZE == 0);
+    assert(flash_offs + count <= sizeof(mock_flash));
+    memset(mock_flash + flash_offs, 0xFF, count);
+    mock_advance_time_us((count / FLASH_SECTOR_SIZE) * MOCK_FLASH_SECTOR_ERASE_uS);
+}
+
+void flash_range_program(uint32_t flash_offs, uint8_t const *data, size_t count) {
+    assert(flash_offs % FLASH_PAGE_SIZE == 0 && count % FLASH_PAGE_SIZE == 0);
+    assert(flash_offs + count <= sizeof(mock_flash));
+    for (size_t i = 0; i < count; i++) {
+        mock_flash[flash_offs + i] &= data[i];
+    }
+    mock_advance_time_us((count / FLASH_PAGE_SIZE) * MOCK_FLASH_PAGE_PROGRAM_uS);
+}
+
+void mock_flash_erase_all(void) {
+    memset(mock_flash, 0xFF, sizeof(mock_flash));
+}
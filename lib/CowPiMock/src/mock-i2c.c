@@ -0,0 +1,39 @@
+/**************************************************************************/
+/**
+ *
+ * @file mock-i2c.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief hardware/i2c.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include "CowPi.h"
+#include "hardware/clocks.h"
+#include "hardware/i2c.h"
+
+i2c_inst_t mock_i2c[2];
+
+uint32_t i2c_set_baudrate(i2c_inst_t *i2c, uint32_t baudrate) {
+    i2c->baud_hz = baudrate;
+    i2c->sys_clock_hz = clock_get_hz(clk_sys);
+    return baudrate;
+}
+
+uint32_t mock_i2c_scl_hz(i2c_inst_t const *i2c) {
+    if (i2c->sys_clock_hz == 0) {
+        return 0;
+    }
+    return (uint32_t) ((uint64_t) i2c->baud_hz * clock_get_hz(clk_sys) / i2c->sys_clock_hz);
+}
+
+void mock_reset_i2c(void) {
+    memset(mock_i2c, 0, sizeof(mock_i2c));
+}
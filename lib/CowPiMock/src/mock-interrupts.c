@@ -0,0 +1,204 @@
+/**************************************************************************/
+/**
+ *
+ * @file mock-interrupts.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Host-side stand-in for <code>interrupt_support</code>, driven by the
+ *      virtual clock and the mock input pins.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include "CowPi.h"
+#include "hardware/sync.h"
+
+// must match interrupt_support.h, which lives with the sources under test
+#define MAXIMUM_NUMBER_OF_TIMERS (8)
+#define MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS (2)
+
+typedef enum {
+    ISR_PRIORITY_CRITICAL,
+    ISR_PRIORITY_HIGH,
+    ISR_PRIORITY_NORMAL,
+    ISR_PRIORITY_LOW,
+    NUMBER_OF_ISR_PRIORITIES
+} isr_priority_t;
+
+typedef struct {
+    uint32_t masked_lines;
+    uint32_t interrupt_status;
+    bool blocks_every_interrupt;
+} critical_section_t;
+
+void register_pin_ISR(uint32_t interrupt_mask, void (*isr)(void));
+void register_pin_ISR_with_priority(uint32_t interrupt_mask, void (*isr)(void), isr_priority_t priority);
+void reset_periodic_timer(unsigned int timer_number);
+bool register_periodic_timer_ISR(unsigned int timer_number, uint32_t period_us, void (*isr)(void));
+bool register_periodic_timer_ISR_with_priority(unsigned int timer_number, uint32_t period_us, void (*isr)(void),
+                                               isr_priority_t priority);
+critical_section_t begin_critical_section(isr_priority_t ceiling);
+void end_critical_section(critical_section_t section);
+
+typedef struct {
+    critical_section_t section;
+    bool has_paused_systick;
+} flash_stall_t;
+
+bool register_flash_safe_timer_ISR(unsigned int timer_number, uint32_t period_us, void (*isr)(void));
+void set_flash_safe_timer_running(unsigned int timer_number, bool is_running);
+flash_stall_t begin_flash_stall(void);
+void end_flash_stall(flash_stall_t stall);
+void discard_pending_pin_interrupts(uint32_t interrupt_mask);
+
+struct mock_timer_data {
+    uint32_t period_us;
+    uint64_t next_due_us;
+    void (*interrupt_service_routine)(void);
+};
+
+bool mock_interrupts_enabled = true;
+
+static void (*pin_isrs[32])(void);
+// the flash-safe timers follow the others
+static struct mock_timer_data timers[MAXIMUM_NUMBER_OF_TIMERS + MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS];
+static void (*flash_safe_isrs[MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS])(void);
+// while flash is stalled, only the flash-safe timers fire; the others wait until the stall ends
+static bool is_flash_stalled = false;
+
+void mock_clear_ISRs(void) {
+    mock_interrupts_enabled = true;
+    is_flash_stalled = false;
+    memset(pin_isrs, 0, sizeof(pin_isrs));
+    memset(timers, 0, sizeof(timers));
+    memset(flash_safe_isrs, 0, sizeof(flash_safe_isrs));
+}
+
+void register_pin_ISR(uint32_t interrupt_mask, void (*isr)(void)) {
+    for (int i = 0; i < 32; i++) {
+        if (interrupt_mask & (1u << i)) {
+            pin_isrs[i] = isr;
+        }
+    }
+}
+
+// ISRs run one at a time, in the order that they come due, so priorities change nothing
+void register_pin_ISR_with_priority(uint32_t interrupt_mask, void (*isr)(void), isr_priority_t priority) {
+    register_pin_ISR(interrupt_mask, isr);
+}
+
+bool register_periodic_timer_ISR_with_priority(unsigned int timer_number, uint32_t period_us, void (*isr)(void),
+                                               isr_priority_t priority) {
+    return register_periodic_timer_ISR(timer_number, period_us, isr);
+}
+
+critical_section_t begin_critical_section(isr_priority_t ceiling) {
+    critical_section_t section = {
+            .masked_lines = 0, .interrupt_status = save_and_disable_interrupts(), .blocks_every_interrupt = true
+    };
+    return section;
+}
+
+void end_critical_section(critical_section_t section) {
+    restore_interrupts(section.interrupt_status);
+}
+
+bool register_periodic_timer_ISR(unsigned int timer_number, uint32_t period_us, void (*isr)(void)) {
+    if (timer_number >= MAXIMUM_NUMBER_OF_TIMERS || period_us == 0) {
+        return false;
+    }
+    timers[timer_number].period_us = period_us;
+    timers[timer_number].next_due_us = mock_time_us() + period_us;
+    timers[timer_number].interrupt_service_routine = isr;
+    return true;
+}
+
+bool register_flash_safe_timer_ISR(unsigned int timer_number, uint32_t period_us, void (*isr)(void)) {
+    if (timer_number >= MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS || period_us == 0) {
+        return false;
+    }
+    flash_safe_isrs[timer_number] = isr;
+    timers[MAXIMUM_NUMBER_OF_TIMERS + timer_number].period_us = period_us;
+    set_flash_safe_timer_running(timer_number, true);
+    return true;
+}
+
+void set_flash_safe_timer_running(unsigned int timer_number, bool is_running) {
+    if (timer_number >= MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS || flash_safe_isrs[timer_number] == NULL) {
+        return;
+    }
+    struct mock_timer_data *timer = &timers[MAXIMUM_NUMBER_OF_TIMERS + timer_number];
+    timer->next_due_us = mock_time_us() + timer->period_us;
+    timer->interrupt_service_routine = is_running ? flash_safe_isrs[timer_number] : NULL;
+}
+
+flash_stall_t begin_flash_stall(void) {
+    flash_stall_t stall = {
+            .section = {.masked_lines = 0, .interrupt_status = is_flash_stalled, .blocks_every_interrupt = false},
+            .has_paused_systick = false
+    };
+    is_flash_stalled = true;
+    return stall;
+}
+
+void end_flash_stall(flash_stall_t stall) {
+    is_flash_stalled = (bool) stall.section.interrupt_status;
+}
+
+// pin changes are never left pending here
+void discard_pending_pin_interrupts(uint32_t interrupt_mask) {}
+
+void reset_periodic_timer(unsigned int timer_number) {
+    if (timer_number < MAXIMUM_NUMBER_OF_TIMERS && timers[timer_number].interrupt_service_routine != NULL) {
+        timers[timer_number].next_due_us = mock_time_us() + timers[timer_number].period_us;
+    }
+}
+
+void mock_run_until_us(uint64_t time_us) {
+    while (true) {
+        // find the timer that comes due first; ties go to the lower-numbered timer
+        struct mock_timer_data *earliest = NULL;
+        int first = is_flash_stalled ? MAXIMUM_NUMBER_OF_TIMERS : 0;
+        for (int i = first; i < MAXIMUM_NUMBER_OF_TIMERS + MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS; i++) {
+            if (timers[i].interrupt_service_routine != NULL
+                && timers[i].next_due_us <= time_us
+                && (earliest == NULL || timers[i].next_due_us < earliest->next_due_us)) {
+                earliest = &timers[i];
+            }
+        }
+        if (earliest == NULL) {
+            break;
+        }
+        if (earliest->next_due_us > mock_time_us()) {
+            mock_set_time_us(earliest->next_due_us);
+        }
+        earliest->next_due_us += earliest->period_us;
+        if (mock_interrupts_enabled) {
+            earliest->interrupt_service_routine();
+        }
+    }
+    if (time_us > mock_time_us()) {
+        mock_set_time_us(time_us);
+    }
+}
+
+void mock_advance_time_us(uint64_t duration_us) {
+    mock_run_until_us(mock_time_us() + duration_us);
+}
+
+void mock_set_input_pins(uint32_t levels, uint32_t pin_mask) {
+    uint32_t previous = mock_sio.input;
+    mock_sio.input = (previous & ~pin_mask) | (levels & pin_mask);
+    uint32_t changed = previous ^ mock_sio.input;
+    for (int i = 0; i < 32; i++) {
+        if ((changed & (1u << i)) && pin_isrs[i] != NULL && mock_interrupts_enabled && !is_flash_stalled) {
+            pin_isrs[i]();
+        }
+    }
+}
@@ -0,0 +1,280 @@
+/**************************************************************************/
+/**
+ *
+ * @file audit-log.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief audit-log.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+// clang-format off
+#include <CowPi.h>
+#include "audit-log.h"
+#include "crc32.h"
+#include "flash-storage.h"
+#include "memory-map.h"
+// clang-format on
+
+#define AUDIT_LOG_MAGIC (0x54494441)    // "ADIT"
+#define ERASED_WORD (0xFFFFFFFF)
+
+#define RECORDS_PER_PAGE (FLASH_STORAGE_PAGE_SIZE / sizeof(struct audit_record))
+#define PAGES_PER_SECTOR (FLASH_STORAGE_SECTOR_SIZE / FLASH_STORAGE_PAGE_SIZE)
+// the first page is the index
+#define DATA_PAGES_PER_SECTOR (PAGES_PER_SECTOR - 1)
+
+_Static_assert(sizeof(struct audit_record) == 16, "audit records must tile a page");
+_Static_assert(AUDIT_LOG_NUMBER_OF_SECTORS >= 2, "the audit log needs a sector to erase while keeping another");
+
+struct audit_sector_index {
+    uint32_t magic;                 // programmed just after the sector is erased
+    uint32_t first_sequence_numbers[DATA_PAGES_PER_SECTOR];
+};
+
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *) (TIMER_BASE_ADDRESS);
+
+// each sector's first sequence number, or ERASED_WORD if it holds no records
+static uint32_t sector_first_sequence_numbers[AUDIT_LOG_NUMBER_OF_SECTORS];
+static unsigned int active_sector = 0;
+static bool is_active_sector_open = false;  // erased and marked, ready for records
+static unsigned int next_page = 1;
+static unsigned int next_slot = 0;
+static uint32_t next_sequence_number = 0;
+
+// the records not yet programmed, bound for next_page starting at next_slot
+static struct audit_record batch[RECORDS_PER_PAGE];
+static unsigned int batch_length = 0;
+static uint32_t batch_started_us;
+static bool batch_holds_alarm = false;
+
+static uint8_t page_buffer[FLASH_STORAGE_PAGE_SIZE];
+
+static inline uint32_t sector_offset(unsigned int sector) {
+    return AUDIT_LOG_OFFSET + sector * FLASH_STORAGE_SECTOR_SIZE;
+}
+
+static inline struct audit_sector_index const *index_of(unsigned int sector) {
+    return (struct audit_sector_index const *) flash_storage_read_pointer(sector_offset(sector));
+}
+
+static inline struct audit_record const *record_at(unsigned int sector, unsigned int page, unsigned int slot) {
+    return (struct audit_record const *) flash_storage_read_pointer(
+            sector_offset(sector) + page * FLASH_STORAGE_PAGE_SIZE + slot * sizeof(struct audit_record));
+}
+
+static inline bool is_valid(struct audit_record const *record) {
+    return record->sequence_number != ERASED_WORD
+           && record->crc == crc32(record, offsetof(struct audit_record, crc));
+}
+
+static inline bool is_erased(struct audit_record const *record) {
+    uint8_t const *bytes = (uint8_t const *) record;
+    for (unsigned int i = 0; i < sizeof(struct audit_record); i++) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t uptime_us(void) {
+    // the upper word is read again in case the lower word wrapped between the reads
+    uint32_t upper;
+    uint32_t lower;
+    do {
+        upper = timer->raw_upper_word;
+        lower = timer->raw_lower_word;
+    } while (upper != timer->raw_upper_word);
+    return ((uint64_t) upper << 32) | lower;
+}
+
+static void advance_page(void) {
+    next_slot = 0;
+    next_page++;
+    if (next_page == PAGES_PER_SECTOR) {
+        // the next sector is erased when its first records are programmed
+        active_sector = (active_sector + 1) % AUDIT_LOG_NUMBER_OF_SECTORS;
+        is_active_sector_open = false;
+        next_page = 1;
+    }
+}
+
+void initialize_audit_log(void) {
+    bool has_records = false;
+    for (unsigned int sector = 0; sector < AUDIT_LOG_NUMBER_OF_SECTORS; sector++) {
+        struct audit_sector_index const *index = index_of(sector);
+        sector_first_sequence_numbers[sector] = (index->magic == AUDIT_LOG_MAGIC)
+                                                ? index->first_sequence_numbers[0] : ERASED_WORD;
+        uint32_t first = sector_first_sequence_numbers[sector];
+        if (first != ERASED_WORD && (!has_records || first > sector_first_sequence_numbers[active_sector])) {
+            active_sector = sector;
+            has_records = true;
+        }
+    }
+    batch_length = 0;
+    batch_holds_alarm = false;
+    if (!has_records) {
+        active_sector = 0;
+        is_active_sector_open = false;
+        next_page = 1;
+        next_slot = 0;
+        next_sequence_number = 0;
+        return;
+    }
+    // the last page with an index entry is the one being filled
+    struct audit_sector_index const *index = index_of(active_sector);
+    unsigned int page = DATA_PAGES_PER_SECTOR;
+    while (index->first_sequence_numbers[page - 1] == ERASED_WORD) {
+        page--;
+    }
+    unsigned int slot = 0;
+    while (slot < RECORDS_PER_PAGE && !is_erased(record_at(active_sector, page, slot))) {
+        slot++;
+    }
+    // a record torn by a power loss keeps its slot and its sequence number
+    next_sequence_number = index->first_sequence_numbers[page - 1] + slot;
+    is_active_sector_open = true;
+    next_page = page;
+    next_slot = slot;
+    if (next_slot == RECORDS_PER_PAGE) {
+        advance_page();
+    }
+}
+
+static void open_active_sector(void) {
+    sector_first_sequence_numbers[active_sector] = ERASED_WORD;
+    flash_storage_erase_sector(sector_offset(active_sector));
+    memset(page_buffer, 0xFF, sizeof(page_buffer));
+    ((struct audit_sector_index *) page_buffer)->magic = AUDIT_LOG_MAGIC;
+    flash_storage_program_page(sector_offset(active_sector), page_buffer);
+    is_active_sector_open = true;
+}
+
+static void program_index_entry(unsigned int page, uint32_t sequence_number) {
+    // bytes left at 0xFF leave the rest of the index untouched
+    memset(page_buffer, 0xFF, sizeof(page_buffer));
+    ((struct audit_sector_index *) page_buffer)->first_sequence_numbers[page - 1] = sequence_number;
+    flash_storage_program_page(sector_offset(active_sector), page_buffer);
+    if (page == 1) {
+        sector_first_sequence_numbers[active_sector] = sequence_number;
+    }
+}
+
+void audit_log_flush(void) {
+    if (batch_length == 0) {
+        return;
+    }
+    if (!is_active_sector_open) {
+        open_active_sector();
+    }
+    if (next_slot == 0) {
+        // the index entry goes first, so that a page with records always has one
+        program_index_entry(next_page, batch[0].sequence_number);
+    }
+    memset(page_buffer, 0xFF, sizeof(page_buffer));
+    memcpy(page_buffer + next_slot * sizeof(struct audit_record), batch, batch_length * sizeof(struct audit_record));
+    flash_storage_program_page(sector_offset(active_sector) + next_page * FLASH_STORAGE_PAGE_SIZE, page_buffer);
+    next_slot += batch_length;
+    batch_length = 0;
+    batch_holds_alarm = false;
+    if (next_slot == RECORDS_PER_PAGE) {
+        advance_page();
+    }
+}
+
+static inline bool batch_fills_page(void) {
+    return batch_length == RECORDS_PER_PAGE - next_slot;
+}
+
+void audit_log_record(audit_event_t event, uint8_t lock, uint16_t detail) {
+    if (batch_fills_page()) {
+        audit_log_flush();
+    }
+    struct audit_record *record = &batch[batch_length];
+    memset(record, 0, sizeof(*record));
+    record->sequence_number = next_sequence_number++;
+    record->timestamp_ms = (uint32_t) (uptime_us() / 1000);
+    record->event = (uint8_t) event;
+    record->lock = lock;
+    record->detail = detail;
+    record->crc = crc32(record, offsetof(struct audit_record, crc));
+    if (batch_length == 0) {
+        batch_started_us = timer->raw_lower_word;
+    }
+    batch_length++;
+    if (event == AUDIT_ALARM) {
+        batch_holds_alarm = true;
+    }
+}
+
+void service_audit_log(void) {
+    if (batch_length > 0
+        && (batch_fills_page() || batch_holds_alarm
+            || timer->raw_lower_word - batch_started_us >= AUDIT_LOG_FLUSH_AFTER_uS)) {
+        audit_log_flush();
+    }
+}
+
+uint32_t audit_log_next_sequence_number(void) {
+    return next_sequence_number;
+}
+
+static struct audit_record const *find_in_flash(uint32_t sequence_number) {
+    // the sector, and then the page, with the latest first record that is not after the one wanted
+    int sector = -1;
+    for (int i = 0; i < AUDIT_LOG_NUMBER_OF_SECTORS; i++) {
+        uint32_t first = sector_first_sequence_numbers[i];
+        if (first != ERASED_WORD && first <= sequence_number
+            && (sector < 0 || first > sector_first_sequence_numbers[sector])) {
+            sector = i;
+        }
+    }
+    if (sector < 0) {
+        return NULL;
+    }
+    struct audit_sector_index const *index = index_of(sector);
+    for (unsigned int page = DATA_PAGES_PER_SECTOR; page >= 1; page--) {
+        uint32_t first = index->first_sequence_numbers[page - 1];
+        if (first != ERASED_WORD && first <= sequence_number) {
+            uint32_t slot = sequence_number - first;
+            if (slot >= RECORDS_PER_PAGE) {
+                return NULL;
+            }
+            struct audit_record const *record = record_at(sector, page, slot);
+            return (is_valid(record) && record->sequence_number == sequence_number) ? record : NULL;
+        }
+    }
+    return NULL;
+}
+
+unsigned int audit_log_read(uint32_t first_sequence_number, struct audit_record records[], unsigned int capacity) {
+    uint32_t end_of_flash = (batch_length > 0) ? batch[0].sequence_number : next_sequence_number;
+    uint32_t oldest = end_of_flash;
+    for (int i = 0; i < AUDIT_LOG_NUMBER_OF_SECTORS; i++) {
+        if (sector_first_sequence_numbers[i] < oldest) {
+            oldest = sector_first_sequence_numbers[i];
+        }
+    }
+    uint32_t sequence_number = (first_sequence_number > oldest) ? first_sequence_number : oldest;
+    unsigned int count = 0;
+    for (; sequence_number < end_of_flash && count < capacity; sequence_number++) {
+        struct audit_record const *record = find_in_flash(sequence_number);
+        if (record) {
+            records[count++] = *record;
+        }
+    }
+    for (unsigned int i = 0; i < batch_length && count < capacity; i++) {
+        if (batch[i].sequence_number >= sequence_number) {
+            records[count++] = batch[i];
+        }
+    }
+    return count;
+}
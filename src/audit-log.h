@@ -0,0 +1,121 @@
+/**************************************************************************/
+/**
+ *
+ * @file audit-log.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief An append-only journal, kept in flash, of the lock's security
+ *      events: boots, unlocks, bad attempts, alarms, and combination changes.
+ *
+ * Each event is a fixed-size record carrying a sequence number, the
+ * milliseconds since boot, and a CRC-32. Records are collected in RAM, one
+ * flash page's worth at a time, and <code>service_audit_log()</code> programs
+ * them once the page is full, once an alarm is waiting, or once the oldest of
+ * them has waited <code>AUDIT_LOG_FLUSH_AFTER_uS</code>. A page that is
+ * programmed before it is full is finished by later programs, so batching
+ * changes how often the lock stalls but never wastes flash. Records still in
+ * RAM are lost if power fails.
+ *
+ * The log is a ring of <code>AUDIT_LOG_NUMBER_OF_SECTORS</code> sectors below
+ * the configuration store. The first page of each sector is its index: a
+ * magic number, then the sequence number of the first record in each of the
+ * sector's other pages, programmed before the page's first record. Within a
+ * page, the record in slot <i>k</i> has the page's first sequence number plus
+ * <i>k</i>. Finding a record therefore reads a handful of index entries, never
+ * the log itself, and so does the scan at boot. When the log is full, the
+ * sector holding the oldest records is erased to make room.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_AUDIT_LOG_H
+#define COMBOLOCK_AUDIT_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef AUDIT_LOG_FLUSH_AFTER_uS
+#define AUDIT_LOG_FLUSH_AFTER_uS (10000000)
+#endif
+
+typedef enum {
+    AUDIT_BOOT,                     // detail: 1 after a warm reset, 0 after a cold start
+    AUDIT_UNLOCKED,
+    AUDIT_BAD_ATTEMPT,              // detail: the number of bad attempts so far
+    AUDIT_ALARM,
+    AUDIT_COMBINATION_CHANGED,
+    NUMBER_OF_AUDIT_EVENTS
+} audit_event_t;
+
+struct audit_record {
+    uint32_t sequence_number;
+    uint32_t timestamp_ms;          // since boot
+    uint8_t event;                  // audit_event_t
+    uint8_t lock;
+    uint16_t detail;
+    uint32_t crc;
+};
+
+/**
+ * Finds where the log ends. Reads only the sectors' indices and the last
+ * page written.
+ */
+void initialize_audit_log(void);
+
+/**
+ * Adds a record to the batch in RAM. If the batch already fills a page, it is
+ * programmed first; otherwise nothing is written to flash.
+ *
+ * @param event What happened
+ * @param lock The lock it happened to
+ * @param detail Event-specific data
+ */
+void audit_log_record(audit_event_t event, uint8_t lock, uint16_t detail);
+
+/**
+ * Programs the batch if it fills a page, holds an alarm, or has waited
+ * <code>AUDIT_LOG_FLUSH_AFTER_uS</code>. Call it once per pass of
+ * <code>loop()</code>, outside the lock controller's step; the caller stalls
+ * for about a millisecond when the batch is programmed, or for tens of
+ * milliseconds when a sector must be erased.
+ */
+void service_audit_log(void);
+
+/**
+ * Programs the batch, however small.
+ */
+void audit_log_flush(void);
+
+/**
+ * @return The sequence number that the next record will get
+ */
+uint32_t audit_log_next_sequence_number(void);
+
+/**
+ * Copies records, oldest first, starting from a sequence number. Records
+ * still in RAM follow those in flash; records that fail their CRC are
+ * skipped.
+ *
+ * @param first_sequence_number The first record wanted; an older record than
+ *      the log still holds starts the copy at the oldest record
+ * @param records Receives the records
+ * @param capacity The number of elements in <code>records</code>
+ * @return The number of records copied
+ */
+unsigned int audit_log_read(uint32_t first_sequence_number, struct audit_record records[], unsigned int capacity);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_AUDIT_LOG_H
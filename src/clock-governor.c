@@ -0,0 +1,225 @@
+/**************************************************************************/
+/**
+ *
+ * @file clock-governor.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief clock-governor.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+// clang-format off
+#include <CowPi.h>
+#include <hardware/clocks.h>
+#include <hardware/i2c.h>
+#include "clock-governor.h"
+#include "input-activity.h"
+#include "memory-map.h"
+#include "servo-bank.h"
+#include "telemetry.h"
+// clang-format on
+
+// the PLL relocks in well under this, and clk_sys runs from clk_ref meanwhile
+#define SWITCH_QUIET_PERIOD_uS (1000)
+
+typedef struct {
+    uint32_t control_and_status;
+    uint32_t reload_value;
+    uint32_t current_value;
+    uint32_t calibration;
+} systick_t;
+
+static volatile systick_t *systick = (systick_t *) (SYSTICK_BASE_ADDRESS);
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *) (TIMER_BASE_ADDRESS);
+
+static uint32_t const profile_khz[NUMBER_OF_LOCK_MODES] = {
+    [LOCKED] = CLOCK_LOCKED_kHZ,
+    [UNLOCKED] = CLOCK_UNLOCKED_kHZ,
+    [ALARMED] = CLOCK_ALARMED_kHZ,
+    [CHANGING] = CLOCK_CHANGING_kHZ,
+};
+
+struct clock_level {
+    struct clock_residency residency;
+    bool is_unreachable;            // the PLL cannot make it, so it is not asked again
+};
+
+static struct clock_level levels[MAXIMUM_CLOCK_LEVELS];
+static unsigned int number_of_levels = 0;
+static struct clock_level *current_level = NULL;
+static uint32_t accounted_until_us = 0;
+
+/*
+ * A hold lasts until CLOCK_IDLE_AFTER_uS after the last input or transfer.
+ * Once it has lapsed, it stays lapsed until the next one, so that the timer
+ * wrapping around cannot revive it.
+ */
+struct hold {
+    uint32_t since_us;
+    bool is_held;
+};
+
+// the I2C blocks count out the bus's clock in cycles of clk_sys
+static i2c_inst_t *kept_i2c = NULL;
+static uint32_t kept_i2c_baud_hz = 0;
+
+static struct hold input_hold;
+static struct hold transfer_hold;
+static uint32_t input_changes_seen = 0;
+
+static struct clock_level *find_level(uint32_t khz) {
+    for (unsigned int i = 0; i < number_of_levels; i++) {
+        if (levels[i].residency.khz == khz) {
+            return &levels[i];
+        }
+    }
+    if (number_of_levels == MAXIMUM_CLOCK_LEVELS) {
+        return NULL;
+    }
+    struct clock_level *level = &levels[number_of_levels++];
+    memset(level, 0, sizeof(*level));
+    level->residency.khz = khz;
+    return level;
+}
+
+static void account_time(uint32_t now) {
+    if (current_level) {
+        current_level->residency.total_us += now - accounted_until_us;
+    }
+    accounted_until_us = now;
+}
+
+static void start_hold(struct hold *hold, uint32_t now) {
+    hold->since_us = now;
+    hold->is_held = true;
+}
+
+static bool is_holding(struct hold *hold, uint32_t now) {
+    if (hold->is_held && now - hold->since_us >= CLOCK_IDLE_AFTER_uS) {
+        hold->is_held = false;
+    }
+    return hold->is_held;
+}
+
+static void keep_peripheral_clock_steady(void) {
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, 48 * MHZ, 48 * MHZ);
+}
+
+static void rescale_systick(uint32_t old_khz, uint32_t new_khz) {
+    // only a SysTick that raises interrupts is keeping time for the RTOS; a free-running one is counting cycles
+    if ((systick->control_and_status & 0x3) == 0x3) {
+        uint64_t ticks = (uint64_t) (systick->reload_value + 1) * new_khz / old_khz;
+        systick->reload_value = (uint32_t) ticks - 1;
+    }
+}
+
+static void switch_clock(uint32_t khz) {
+    if (current_level && current_level->residency.khz == khz) {
+        return;
+    }
+    struct clock_level *level = find_level(khz);
+    if (!level || level->is_unreachable) {
+        return;
+    }
+    // rather than wait for a gap in the servo signal, try again on a later pass
+    if (!servo_is_quiet_for(SWITCH_QUIET_PERIOD_uS)) {
+        return;
+    }
+    uint32_t old_khz = get_clock_khz();
+    uint32_t start = telemetry_start();
+    bool is_switched = set_sys_clock_khz(khz, false);
+    if (is_switched) {
+        // the SDK may have put clk_peri back on clk_sys
+        keep_peripheral_clock_steady();
+        rescale_systick(old_khz, khz);
+        if (kept_i2c) {
+            i2c_set_baudrate(kept_i2c, kept_i2c_baud_hz);
+        }
+    }
+    telemetry_finish(TELEMETRY_CLOCK_SWITCH, start);
+    if (!is_switched) {
+        level->is_unreachable = true;
+        return;
+    }
+    account_time(timer->raw_lower_word);
+    current_level = level;
+    level->residency.entries++;
+}
+
+void initialize_clock_governor(void) {
+    if (!CLOCK_GOVERNOR_ENABLED) {
+        return;
+    }
+    keep_peripheral_clock_steady();
+    number_of_levels = 0;
+    current_level = find_level(get_clock_khz());
+    accounted_until_us = timer->raw_lower_word;
+    input_changes_seen = count_input_changes();
+    // booting counts as activity
+    start_hold(&input_hold, accounted_until_us);
+    transfer_hold.is_held = false;
+}
+
+void keep_i2c_baud_rate(unsigned int instance, uint32_t baud_hz) {
+    kept_i2c = instance ? i2c1 : i2c0;
+    kept_i2c_baud_hz = baud_hz;
+}
+
+void govern_clock(lock_mode_t mode) {
+    if (!CLOCK_GOVERNOR_ENABLED) {
+        return;
+    }
+    uint32_t now = timer->raw_lower_word;
+    uint32_t changes = count_input_changes();
+    if (changes != input_changes_seen) {
+        input_changes_seen = changes;
+        start_hold(&input_hold, now);
+    }
+    uint32_t khz = (mode < NUMBER_OF_LOCK_MODES) ? profile_khz[mode] : CLOCK_ACTIVE_kHZ;
+    if (is_holding(&input_hold, now)) {
+        khz = CLOCK_ACTIVE_kHZ;
+    } else if (is_holding(&transfer_hold, now) && khz < CLOCK_TRANSFER_kHZ) {
+        khz = CLOCK_TRANSFER_kHZ;
+    }
+    switch_clock(khz);
+}
+
+void raise_clock_for_transfer(void) {
+    if (!CLOCK_GOVERNOR_ENABLED) {
+        return;
+    }
+    start_hold(&transfer_hold, timer->raw_lower_word);
+    if (get_clock_khz() < CLOCK_TRANSFER_kHZ) {
+        switch_clock(CLOCK_TRANSFER_kHZ);
+    }
+}
+
+uint32_t get_clock_khz(void) {
+    return clock_get_hz(clk_sys) / KHZ;
+}
+
+unsigned int get_clock_residency(struct clock_residency residency[], unsigned int capacity) {
+    account_time(timer->raw_lower_word);
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < number_of_levels && count < capacity; i++) {
+        if (levels[i].residency.total_us > 0 || &levels[i] == current_level) {
+            residency[count++] = levels[i].residency;
+        }
+    }
+    return count;
+}
+
+void clear_clock_residency(void) {
+    for (unsigned int i = 0; i < number_of_levels; i++) {
+        levels[i].residency.entries = 0;
+        levels[i].residency.total_us = 0;
+    }
+    accounted_until_us = timer->raw_lower_word;
+}
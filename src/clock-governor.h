@@ -0,0 +1,155 @@
+/**************************************************************************/
+/**
+ *
+ * @file clock-governor.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Lowers the system clock while no one is using the lock, and raises
+ *      it again for input and display transfers.
+ *
+ * Each lock mode has a profile: the frequency that it settles to once there
+ * has been no input for <code>CLOCK_IDLE_AFTER_uS</code>. Any input raises the
+ * clock to <code>CLOCK_ACTIVE_kHZ</code> until the lock has been idle that
+ * long again. A display transfer raises the clock to at least
+ * <code>CLOCK_TRANSFER_kHZ</code>, and it stays there until there have been no
+ * transfers for <code>CLOCK_IDLE_AFTER_uS</code>, so that a display that is
+ * refreshed every pass does not change the clock twice a pass. Each profile
+ * can be overridden with a build flag, such as
+ * <code>-D CLOCK_LOCKED_kHZ=48000</code>.
+ *
+ * The microsecond timer, and so every timer ISR, runs from the reference
+ * clock, which does not change. The governor moves the peripheral clock onto
+ * the USB PLL, so that the UARTs keep their baud rates; it must therefore be
+ * initialized before them. The I2C blocks, however, run from the system clock
+ * itself, so the governor sets the baud rate of any bus that it has been told
+ * to keep again after each switch. It also rescales the RTOS's SysTick, and
+ * it switches only when the servo ISR reports that the signal
+ * is in its quiet period, so that the brief run from the reference clock
+ * while the PLL relocks never delays a servo edge. It never waits for that
+ * gap: a switch that would overlap a pulse is left for a later pass. Each
+ * switch is timed as <code>TELEMETRY_CLOCK_SWITCH</code>, whose maximum is
+ * the most that switching has added to a pass of <code>loop()</code>.
+ *
+ * Time spent at each frequency is kept until it is cleared, along with the
+ * number of times that frequency was entered.
+ *
+ * The governor can be compiled out with
+ * <code>-D CLOCK_GOVERNOR_ENABLED=0</code>, which leaves the clock alone.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_CLOCK_GOVERNOR_H
+#define COMBOLOCK_CLOCK_GOVERNOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lock-bank.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CLOCK_GOVERNOR_ENABLED
+#define CLOCK_GOVERNOR_ENABLED (1)
+#endif
+
+#ifndef CLOCK_ACTIVE_kHZ
+#define CLOCK_ACTIVE_kHZ (125000)           // the SDK's default clk_sys
+#endif
+
+#ifndef CLOCK_TRANSFER_kHZ
+#define CLOCK_TRANSFER_kHZ (48000)
+#endif
+
+#ifndef CLOCK_LOCKED_kHZ
+#define CLOCK_LOCKED_kHZ (20000)
+#endif
+
+#ifndef CLOCK_UNLOCKED_kHZ
+#define CLOCK_UNLOCKED_kHZ (48000)
+#endif
+
+#ifndef CLOCK_ALARMED_kHZ
+#define CLOCK_ALARMED_kHZ (48000)
+#endif
+
+#ifndef CLOCK_CHANGING_kHZ
+#define CLOCK_CHANGING_kHZ (CLOCK_ACTIVE_kHZ)
+#endif
+
+#ifndef CLOCK_IDLE_AFTER_uS
+#define CLOCK_IDLE_AFTER_uS (1000000)
+#endif
+
+#define MAXIMUM_CLOCK_LEVELS (8)
+
+struct clock_residency {
+    uint32_t khz;
+    uint32_t entries;               // times the clock was switched to this frequency
+    uint64_t total_us;
+};
+
+/**
+ * Moves the peripheral clock off the system clock and starts accounting for
+ * the time at the current frequency. Call it before anything that derives a
+ * baud rate from the peripheral clock.
+ */
+void initialize_clock_governor(void);
+
+/**
+ * Has the governor keep an I2C bus at its baud rate across clock switches.
+ * Call it once the bus has been set up; a bus whose driver sets the baud rate
+ * before each transfer does not need it.
+ *
+ * @param instance The I2C block, 0 or 1
+ * @param baud_hz The bus's baud rate
+ */
+void keep_i2c_baud_rate(unsigned int instance, uint32_t baud_hz);
+
+/**
+ * Chooses the clock for the lock's mode and recent activity, and switches to
+ * it if it differs from the current clock. Call it once per pass of
+ * <code>loop()</code>.
+ *
+ * @param mode The lock's mode
+ */
+void govern_clock(lock_mode_t mode);
+
+/**
+ * Raises the clock, if it is below <code>CLOCK_TRANSFER_kHZ</code>, for a
+ * display transfer that is about to start.
+ */
+void raise_clock_for_transfer(void);
+
+/**
+ * @return The current system clock frequency, in kHz
+ */
+uint32_t get_clock_khz(void);
+
+/**
+ * Copies the time spent at each frequency since the residency was last
+ * cleared, counting the current frequency up to now.
+ *
+ * @param residency Receives the frequencies, in the order they were first used
+ * @param capacity The number of elements in <code>residency</code>
+ * @return The number of frequencies copied
+ */
+unsigned int get_clock_residency(struct clock_residency residency[], unsigned int capacity);
+
+/**
+ * Clears the time spent at each frequency.
+ */
+void clear_clock_residency(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_CLOCK_GOVERNOR_H
@@ -21,10 +21,18 @@
 
 
 #include <CowPi.h>
+#include "audit-log.h"
+#include "clock-governor.h"
+#include "diagnostics.h"
 #include "display.h"
+#include "format.h"
+#include "keypad.h"
 #include "rotary-encoder.h"
 #include "servomotor.h"
+#include "lock-config.h"
 #include "lock-controller.h"
+#include "lock-bank.h"
+#include "telemetry.h"
 
 static bool test_mode;
 
@@ -34,15 +42,34 @@ void setup() {
                 (cowpi_display_module_t) {.display_module = NO_MODULE},
                 (cowpi_display_module_protocol_t) {.protocol = NO_PROTOCOL}
                );
+    telemetry_mark_boot(TELEMETRY_BOOT_COWPI_SETUP);
+    // before anything that takes a baud rate from the peripheral clock; the display's I2C bus runs from clk_sys, and the governor keeps its rate
+    initialize_clock_governor();
+    telemetry_mark_boot(TELEMETRY_BOOT_CLOCK_GOVERNOR);
     initialize_display(21);
+    telemetry_mark_boot(TELEMETRY_BOOT_DISPLAY);
     initialize_rotary_encoder();
+    telemetry_mark_boot(TELEMETRY_BOOT_ROTARY_ENCODER);
     initialize_servo();
+    telemetry_mark_boot(TELEMETRY_BOOT_SERVO);
+    initialize_keypad();
+    telemetry_mark_boot(TELEMETRY_BOOT_KEYPAD);
     initialize_lock_controller();
+    telemetry_mark_boot(TELEMETRY_BOOT_LOCK_CONTROLLER);
+#if !FAST_BOOT
     print_build_timestamps(true);
+    telemetry_mark_boot(TELEMETRY_BOOT_BUILD_TIMESTAMPS);
+#endif
     test_mode = cowpi_right_switch_is_in_left_position();
 }
 
 void loop() {
+    static bool is_first_pass = true;
+    if (is_first_pass) {
+        telemetry_mark_boot(TELEMETRY_BOOT_READY);
+    }
+    // an input raises the clock before the controller handles it
+    govern_clock(get_bank_mode());
     if (test_mode) {
         static char rotations_buffer[22] = {0};
         static char servo_buffer[22] = {0};
@@ -52,7 +79,11 @@ void loop() {
         test_servo(servo_buffer);
         display_string(2, servo_buffer);
         uint8_t const *combination = get_combination();
-        sprintf(combo_buffer, "Combo: %02d-%02d-%02d", combination[0], combination[1], combination[2]);
+        // long combinations don't leave room for the label
+        char *cursor = (COMBINATION_TEXT_LENGTH + 7 <= 21) ? FORMAT(combo_buffer, "Combo: ") : combo_buffer;
+        for (int i = 0; i < COMBINATION_LENGTH; i++) {
+            cursor = FORMAT(cursor, (i == 0) ? "" : "-", zero_padded_field(combination[i], DIGITS_PER_NUMBER));
+        }
         display_string(3, combo_buffer);
         static bool is_pressed = false;
         if (cowpi_right_button_is_pressed() && !is_pressed) {
@@ -66,5 +97,17 @@ void loop() {
         control_lock();
     }
     refresh_display();
+    // outside the controller's step, so that programming the audit log never delays a response
+    service_audit_log();
+    if (is_first_pass) {
+        telemetry_mark_boot(TELEMETRY_BOOT_FIRST_FRAME);
+#if FAST_BOOT
+        // deferred from setup(), now that the lock has had its first chance to respond
+        print_build_timestamps(true);
+        telemetry_mark_boot(TELEMETRY_BOOT_BUILD_TIMESTAMPS);
+#endif
+        is_first_pass = false;
+    }
     count_visits(7);
+    service_diagnostics();
 }
\ No newline at end of file
@@ -0,0 +1,186 @@
+/**************************************************************************/
+/**
+ *
+ * @file config-store.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief config-store.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+// clang-format off
+#include <CowPi.h>
+#include "config-store.h"
+#include "crc32.h"
+#include "flash-storage.h"
+#include "lock-config.h"
+// clang-format on
+
+#define ERASED_SEQUENCE_NUMBER (0xFFFFFFFF)
+
+/*
+ * The payload holds the lock's shape followed by the combination and, in a
+ * bank, the lock's index, padded so that records tile a page. A single lock's
+ * records have no index, so that they match those written before there were
+ * banks; an index left erased reads as lock 0.
+ */
+#define LOCK_INDEX_OFFSET (COMBINATION_LENGTH + 2)
+#define PAYLOAD_BYTES_USED (LOCK_INDEX_OFFSET + ((NUMBER_OF_LOCKS > 1) ? 1 : 0))
+#define PAYLOAD_SIZE ((PAYLOAD_BYTES_USED <= 8) ? 8 : 24)
+_Static_assert(PAYLOAD_BYTES_USED <= 24, "the combination must fit in a config record");
+
+struct config_record {
+    uint32_t sequence_number;
+    uint8_t payload[PAYLOAD_SIZE];
+    uint32_t crc;
+};
+
+#define RECORDS_PER_SECTOR (FLASH_STORAGE_SECTOR_SIZE / sizeof(struct config_record))
+#define RECORDS_PER_PAGE (FLASH_STORAGE_PAGE_SIZE / sizeof(struct config_record))
+
+// a sector must hold a copy of every lock's record and still have room for a new one
+_Static_assert(RECORDS_PER_SECTOR > NUMBER_OF_LOCKS, "the bank's records must fit in one sector");
+
+static bool is_initialized = false;
+static bool has_valid_record[NUMBER_OF_LOCKS];
+static struct config_record latest_record[NUMBER_OF_LOCKS];
+static uint32_t latest_sequence_number;
+static bool has_any_valid_record;
+static unsigned int active_sector;
+static unsigned int next_slot;      // the first never-written slot in the active sector
+
+static inline struct config_record const *record_at(unsigned int sector, unsigned int slot) {
+    return (struct config_record const *) flash_storage_read_pointer(
+            CONFIG_STORE_OFFSET + sector * FLASH_STORAGE_SECTOR_SIZE + slot * sizeof(struct config_record));
+}
+
+static inline bool is_valid(struct config_record const *record) {
+    return record->sequence_number != ERASED_SEQUENCE_NUMBER
+           && record->crc == crc32(record, offsetof(struct config_record, crc))
+           && record->payload[0] == COMBINATION_LENGTH
+           && record->payload[1] == DIAL_POSITIONS;
+}
+
+static inline uint8_t lock_of(struct config_record const *record) {
+#if NUMBER_OF_LOCKS > 1
+    return (record->payload[LOCK_INDEX_OFFSET] == 0xFF) ? 0 : record->payload[LOCK_INDEX_OFFSET];
+#else
+    return 0;
+#endif
+}
+
+static inline bool is_erased(struct config_record const *record) {
+    uint8_t const *bytes = (uint8_t const *) record;
+    for (unsigned int i = 0; i < sizeof(struct config_record); i++) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void initialize_config_store() {
+    unsigned int used_slots[CONFIG_STORE_NUMBER_OF_SECTORS];
+    memset(has_valid_record, 0, sizeof(has_valid_record));
+    has_any_valid_record = false;
+    active_sector = 0;
+    for (unsigned int sector = 0; sector < CONFIG_STORE_NUMBER_OF_SECTORS; sector++) {
+        // records are appended in order, so the first erased slot ends the sector's log
+        unsigned int slot = 0;
+        while (slot < RECORDS_PER_SECTOR && !is_erased(record_at(sector, slot))) {
+            struct config_record const *record = record_at(sector, slot);
+            uint8_t lock = lock_of(record);
+            if (is_valid(record) && lock < NUMBER_OF_LOCKS
+                && (!has_valid_record[lock] || record->sequence_number > latest_record[lock].sequence_number)) {
+                latest_record[lock] = *record;
+                has_valid_record[lock] = true;
+            }
+            if (is_valid(record)
+                && (!has_any_valid_record || record->sequence_number > latest_sequence_number)) {
+                // the most recent record of any lock marks the active sector
+                latest_sequence_number = record->sequence_number;
+                has_any_valid_record = true;
+                active_sector = sector;
+            }
+            slot++;
+        }
+        used_slots[sector] = slot;
+    }
+    next_slot = used_slots[active_sector];
+    is_initialized = true;
+}
+
+bool load_combination(uint8_t combination[COMBINATION_LENGTH]) {
+    return load_lock_combination(0, combination);
+}
+
+bool load_lock_combination(uint8_t lock, uint8_t combination[COMBINATION_LENGTH]) {
+    if (!has_valid_record[lock]) {
+        return false;
+    }
+    memcpy(combination, latest_record[lock].payload + 2, COMBINATION_LENGTH);
+    return true;
+}
+
+bool save_combination(uint8_t const combination[COMBINATION_LENGTH]) {
+    return save_lock_combination(0, combination);
+}
+
+static bool append_record(struct config_record const *record) {
+    // bytes left at 0xFF leave the page's other records untouched
+    static uint8_t page[FLASH_STORAGE_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page + (next_slot % RECORDS_PER_PAGE) * sizeof(struct config_record), record, sizeof(*record));
+    uint32_t page_offset = CONFIG_STORE_OFFSET + active_sector * FLASH_STORAGE_SECTOR_SIZE
+                           + (next_slot / RECORDS_PER_PAGE) * FLASH_STORAGE_PAGE_SIZE;
+    flash_storage_program_page(page_offset, page);
+    struct config_record const *written = record_at(active_sector, next_slot);
+    next_slot++;
+    return is_valid(written) && written->sequence_number == record->sequence_number;
+}
+
+bool save_lock_combination(uint8_t lock, uint8_t const combination[COMBINATION_LENGTH]) {
+    if (!is_initialized) {
+        // a warm boot restores the combination from RAM and defers the scan until it is needed
+        initialize_config_store();
+    }
+    struct config_record record;
+    memset(&record, 0xFF, sizeof(record));
+    record.sequence_number = has_any_valid_record ? latest_sequence_number + 1 : 0;
+    record.payload[0] = COMBINATION_LENGTH;
+    record.payload[1] = DIAL_POSITIONS;
+    memcpy(record.payload + 2, combination, COMBINATION_LENGTH);
+#if NUMBER_OF_LOCKS > 1
+    record.payload[LOCK_INDEX_OFFSET] = lock;
+#endif
+    record.crc = crc32(&record, offsetof(struct config_record, crc));
+    if (next_slot >= RECORDS_PER_SECTOR || (!has_any_valid_record && next_slot > 0)) {
+        // switch sectors; the old sector keeps the latest records until the new one has them
+        if (has_any_valid_record) {
+            active_sector = (active_sector + 1) % CONFIG_STORE_NUMBER_OF_SECTORS;
+        }
+        flash_storage_erase_sector(CONFIG_STORE_OFFSET + active_sector * FLASH_STORAGE_SECTOR_SIZE);
+        next_slot = 0;
+        // the other locks' records are carried forward before the old sector can be erased
+        for (uint8_t other = 0; other < NUMBER_OF_LOCKS; other++) {
+            if (other != lock && has_valid_record[other]) {
+                append_record(&latest_record[other]);
+            }
+        }
+    }
+    if (!append_record(&record)) {
+        return false;
+    }
+    latest_record[lock] = record;
+    has_valid_record[lock] = true;
+    latest_sequence_number = record.sequence_number;
+    has_any_valid_record = true;
+    return true;
+}
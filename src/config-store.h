@@ -0,0 +1,85 @@
+/**************************************************************************/
+/**
+ *
+ * @file config-store.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Flash-backed storage for the combination of each lock in the bank.
+ *
+ * Each save appends a fixed-size record, carrying a sequence number and a
+ * CRC-32, to one of two reserved flash sectors. A record also notes the
+ * combination length and dial size it was written for, so that firmware built
+ * for a different lock ignores it. When the active sector fills,
+ * the other sector is erased and becomes active, so each sector is erased
+ * only once per sector's worth of saves. At boot, one pass over both sectors
+ * finds each lock's valid record with the highest sequence number; records
+ * left incomplete by a power loss fail their CRC and are skipped. In a bank,
+ * each record also notes its lock, and switching sectors first copies the
+ * other locks' latest records into the new sector.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_CONFIG_STORE_H
+#define COMBOLOCK_CONFIG_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lock-config.h"
+
+/**
+ * Scans the reserved sectors for the most recent valid record.
+ * Must be called before <code>load_combination()</code>;
+ * <code>save_combination()</code> calls it if it has not yet been called.
+ */
+void initialize_config_store();
+
+/**
+ * Retrieves the most recently saved combination of the first lock.
+ *
+ * @param combination The array to receive the combination's numbers
+ * @return <code>true</code> if a valid record was found;
+ *      <code>false</code> otherwise, in which case <code>combination</code>
+ *      is unchanged
+ */
+bool load_combination(uint8_t combination[COMBINATION_LENGTH]);
+
+/**
+ * Retrieves the most recently saved combination of a lock.
+ *
+ * @param lock The lock, less than <code>NUMBER_OF_LOCKS</code>
+ * @param combination The array to receive the combination's numbers
+ * @return <code>true</code> if a valid record was found for the lock;
+ *      <code>false</code> otherwise, in which case <code>combination</code>
+ *      is unchanged
+ */
+bool load_lock_combination(uint8_t lock, uint8_t combination[COMBINATION_LENGTH]);
+
+/**
+ * Appends a record holding the first lock's combination. The caller stalls for about a
+ * millisecond, or for tens of milliseconds when a sector must be erased.
+ *
+ * @param combination The combination's numbers
+ * @return <code>true</code> if the record was written and reads back
+ *      correctly; <code>false</code> otherwise
+ */
+bool save_combination(uint8_t const combination[COMBINATION_LENGTH]);
+
+/**
+ * Appends a record holding a lock's combination, as
+ * <code>save_combination()</code> does.
+ *
+ * @param lock The lock, less than <code>NUMBER_OF_LOCKS</code>
+ * @param combination The combination's numbers
+ * @return <code>true</code> if the record was written and reads back
+ *      correctly; <code>false</code> otherwise
+ */
+bool save_lock_combination(uint8_t lock, uint8_t const combination[COMBINATION_LENGTH]);
+
+#endif //COMBOLOCK_CONFIG_STORE_H
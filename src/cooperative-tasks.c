@@ -0,0 +1,46 @@
+/**************************************************************************/
+/**
+ *
+ * @file cooperative-tasks.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Time and keypad sources for the cooperative task primitives.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+// clang-format off
+#include <CowPi.h>
+#include "memory-map.h"
+#include "cooperative-tasks.h"
+#include "keypad.h"
+#include "telemetry.h"
+// clang-format on
+
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *)(TIMER_BASE_ADDRESS);
+
+uint32_t task_clock_us() {
+    return timer->raw_lower_word;
+}
+
+bool deadline_has_passed(uint32_t deadline_us) {
+    // signed difference keeps working when the 32-bit counter wraps
+    return (int32_t)(task_clock_us() - deadline_us) >= 0;
+}
+
+char next_keypress() {
+    key_event_t event;
+    while (take_key_event(&event)) {
+        if (event.action == KEY_PRESSED) {
+            telemetry_tag_queued_input(event.timestamp_us);
+            return event.key;
+        }
+    }
+    return '\0';
+}
@@ -0,0 +1,109 @@
+/**************************************************************************/
+/**
+ *
+ * @file cooperative-tasks.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Stackless cooperative tasks (protothreads) for multi-step flows that
+ *      must wait without blocking <code>loop()</code>.
+ *
+ * A task is an ordinary function that takes a <code>task_t *</code> and
+ * brackets its body with <code>TASK_BEGIN()</code> and <code>TASK_END()</code>.
+ * Each <code>AWAIT...()</code> records where the task stopped and returns;
+ * the next call resumes at that point. Because the task has no stack of its
+ * own, any variable that must survive an <code>AWAIT...()</code> has to be
+ * <code>static</code> (or live in the task's context), and an
+ * <code>AWAIT...()</code> cannot appear inside a nested <code>switch</code>.
+ *
+ * When a task reaches <code>TASK_END()</code> it rewinds, so the next call
+ * starts over from the top. That makes a task's body read as a loop that
+ * begins by awaiting whatever starts the flow.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_COOPERATIVE_TASKS_H
+#define COMBOLOCK_COOPERATIVE_TASKS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    TASK_WAITING,
+    TASK_FINISHED
+} task_status_t;
+
+typedef struct {
+    uint16_t resume_point;
+    uint32_t deadline_us;
+} task_t;
+
+typedef uint8_t task_events_t;
+
+#define TASK_BEGIN(task)  switch ((task)->resume_point) { case 0:
+
+#define TASK_END(task)    } (task)->resume_point = 0; return TASK_FINISHED
+
+/**
+ * Suspends the task until <code>condition</code> is true. The condition is
+ * re-evaluated each time the task is called.
+ */
+#define AWAIT(task, condition)                                  \
+    do {                                                        \
+        (task)->resume_point = __LINE__;                        \
+        __attribute__((fallthrough));                           \
+        case __LINE__:                                          \
+        if (!(condition)) return TASK_WAITING;                  \
+    } while (0)
+
+/**
+ * Suspends the task for at least <code>delay_us</code> microseconds.
+ */
+#define AWAIT_DEADLINE(task, delay_us)                          \
+    do {                                                        \
+        (task)->deadline_us = task_clock_us() + (delay_us);     \
+        AWAIT(task, deadline_has_passed((task)->deadline_us));  \
+    } while (0)
+
+/**
+ * Suspends the task until any of the events in <code>mask</code> has been
+ * posted, then consumes those events.
+ */
+#define AWAIT_EVENT(task, events, mask)                         \
+    AWAIT(task, take_events(events, mask))
+
+/**
+ * Suspends the task until the keypad's queue holds a key-down event, then
+ * stores its key in <code>key</code>. Key-up events are skipped.
+ */
+#define AWAIT_KEY(task, key)                                    \
+    AWAIT(task, ((key) = next_keypress()) != '\0')
+
+/**
+ * Rewinds a task so that its next call starts from <code>TASK_BEGIN()</code>.
+ */
+static inline void task_reset(task_t *task) {
+    task->resume_point = 0;
+}
+
+static inline void post_events(task_events_t volatile *events, task_events_t mask) {
+    *events |= mask;
+}
+
+static inline bool take_events(task_events_t volatile *events, task_events_t mask) {
+    task_events_t pending = *events & mask;
+    *events &= (task_events_t) ~pending;
+    return pending != 0;
+}
+
+uint32_t task_clock_us();
+bool deadline_has_passed(uint32_t deadline_us);
+char next_keypress();
+
+#endif //COMBOLOCK_COOPERATIVE_TASKS_H
@@ -0,0 +1,40 @@
+/**************************************************************************/
+/**
+ *
+ * @file crc32.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief crc32.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include "crc32.h"
+
+// a nibble-wide table keeps the flash cost at 64 bytes instead of 1 KiB
+static uint32_t const crc_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t crc32_extend(uint32_t crc, void const *data, size_t length) {
+    uint8_t const *bytes = (uint8_t const *) data;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        crc = (crc >> 4) ^ crc_table[crc & 0xF];
+        crc = (crc >> 4) ^ crc_table[crc & 0xF];
+    }
+    return crc;
+}
+
+uint32_t crc32(void const *data, size_t length) {
+    return crc32_finish(crc32_extend(crc32_start(), data, length));
+}
@@ -0,0 +1,58 @@
+/**************************************************************************/
+/**
+ *
+ * @file crc32.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief CRC-32 (IEEE 802.3, reflected, as used by zlib) for validating data
+ *      that must survive a reset or a power cycle.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_CRC32_H
+#define COMBOLOCK_CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Computes the CRC-32 of <code>length</code> bytes starting at
+ * <code>data</code>.
+ *
+ * @param data The bytes to be checked
+ * @param length The number of bytes
+ * @return The CRC-32 of the bytes
+ */
+uint32_t crc32(void const *data, size_t length);
+
+/**
+ * Computes a CRC-32 over data that arrives in pieces:
+ * <code>crc32_finish(crc32_extend(crc32_extend(crc32_start(), a, m), b, n))</code>
+ * equals the <code>crc32()</code> of <code>a</code> followed by <code>b</code>.
+ */
+static inline uint32_t crc32_start(void) {
+    return 0xFFFFFFFF;
+}
+
+uint32_t crc32_extend(uint32_t crc, void const *data, size_t length);
+
+static inline uint32_t crc32_finish(uint32_t crc) {
+    return ~crc;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_CRC32_H
@@ -0,0 +1,349 @@
+/**************************************************************************/
+/**
+ *
+ * @file diagnostics.cpp
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief diagnostics.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include "audit-log.h"
+#include "clock-governor.h"
+#include "crc32.h"
+#include "diagnostics.h"
+#include "format.h"
+#include "interrupt_support.h"
+#include "serial-log.h"
+#include "telemetry.h"
+#include "trace.h"
+
+static uint8_t constexpr FRAME_SYNC[] = {0xA5, 0x5A};
+static uint8_t constexpr TRACE_FORMAT_VERSION = 1;
+static uint8_t constexpr TELEMETRY_FORMAT_VERSION = 1;
+static uint8_t constexpr AUDIT_FORMAT_VERSION = 1;
+static unsigned int constexpr AUDIT_RECORDS_PER_FRAME = 16;
+
+/*
+ * Queues a frame's bytes as one serial-log record while keeping a running CRC.
+ * The CRC is computed over the frame in pieces, so the frame never needs to be
+ * assembled outside the log.
+ */
+class FrameWriter {
+public:
+    FrameWriter(uint8_t frame_type, uint16_t payload_length) {
+        serial_log_begin();
+        serial_log_append(FRAME_SYNC, sizeof(FRAME_SYNC));
+        uint8_t header[] = {frame_type, (uint8_t) (payload_length & 0xFF), (uint8_t) (payload_length >> 8)};
+        write(header, sizeof(header));
+    }
+
+    void write(void const *data, size_t length) {
+        serial_log_append(data, length);
+        crc = crc32_extend(crc, data, length);
+    }
+
+    void write_little_endian(uint64_t value, size_t length) {
+        uint8_t bytes[8];
+        for (size_t i = 0; i < length; i++) {
+            bytes[i] = (uint8_t) (value >> (8 * i));
+        }
+        write(bytes, length);
+    }
+
+    void finish() {
+        uint32_t final_crc = crc32_finish(crc);
+        uint8_t trailer[] = {(uint8_t) final_crc, (uint8_t) (final_crc >> 8),
+                             (uint8_t) (final_crc >> 16), (uint8_t) (final_crc >> 24)};
+        serial_log_append(trailer, sizeof(trailer));
+        serial_log_end();
+    }
+
+private:
+    uint32_t crc = crc32_start();
+};
+
+static void send_trace() {
+    uint32_t total_recorded;
+    uint16_t count = trace_pause(&total_recorded);
+    uint16_t payload_length = 8 + count * sizeof(struct trace_event);
+    FrameWriter frame('T', payload_length);
+    uint8_t header[] = {
+            TRACE_FORMAT_VERSION, (uint8_t) sizeof(struct trace_event),
+            (uint8_t) total_recorded, (uint8_t) (total_recorded >> 8),
+            (uint8_t) (total_recorded >> 16), (uint8_t) (total_recorded >> 24),
+            (uint8_t) count, (uint8_t) (count >> 8)
+    };
+    frame.write(header, sizeof(header));
+    for (uint16_t i = 0; i < count; i++) {
+        frame.write(trace_event_at(i), sizeof(struct trace_event));
+    }
+    frame.finish();
+    trace_resume();
+}
+
+static void send_telemetry() {
+    struct telemetry_snapshot snapshot;
+    telemetry_take_snapshot(&snapshot);
+    uint16_t constexpr phase_length = 4 + 8 + 4 + 4 * TELEMETRY_HISTOGRAM_BUCKETS;
+    uint16_t constexpr payload_length = 8 + 4 * NUMBER_OF_TELEMETRY_COUNTERS + phase_length * NUMBER_OF_TELEMETRY_PHASES;
+    FrameWriter frame('S', payload_length);
+    uint8_t header[] = {
+            TELEMETRY_FORMAT_VERSION, NUMBER_OF_TELEMETRY_COUNTERS, NUMBER_OF_TELEMETRY_PHASES,
+            TELEMETRY_HISTOGRAM_BUCKETS
+    };
+    frame.write(header, sizeof(header));
+    frame.write_little_endian(snapshot.window_us, 4);
+    for (uint32_t counter : snapshot.counters) {
+        frame.write_little_endian(counter, 4);
+    }
+    for (struct telemetry_phase const &phase : snapshot.phases) {
+        frame.write_little_endian(phase.count, 4);
+        frame.write_little_endian(phase.total_us, 8);
+        frame.write_little_endian(phase.maximum_us, 4);
+        for (uint32_t bucket : phase.histogram) {
+            frame.write_little_endian(bucket, 4);
+        }
+    }
+    frame.finish();
+}
+
+static void print_telemetry() {
+    struct telemetry_snapshot snapshot;
+    telemetry_take_snapshot(&snapshot);
+    // room for the longest line: a phase's, with a 14-character name and three 10-digit numbers
+    char line[96];
+    uint32_t loops = snapshot.phases[TELEMETRY_LOOP].count;
+    FORMAT(line, "window_us ", snapshot.window_us, " loops_per_s ",
+           (uint32_t) (snapshot.window_us ? (uint64_t) loops * 1000000 / snapshot.window_us : 0));
+    serial_log_line(line);
+    for (int i = 0; i < NUMBER_OF_TELEMETRY_COUNTERS; i++) {
+        FORMAT(line, "counter ", telemetry_counter_name((telemetry_counter_t) i), " ", snapshot.counters[i]);
+        serial_log_line(line);
+    }
+    for (int i = 0; i < NUMBER_OF_TELEMETRY_PHASES; i++) {
+        struct telemetry_phase const &phase = snapshot.phases[i];
+        FORMAT(line, "phase ", telemetry_phase_name((telemetry_phase_t) i), " count ", phase.count,
+               " mean_us ", (uint32_t) (phase.count ? phase.total_us / phase.count : 0),
+               " max_us ", phase.maximum_us, " histogram");
+        serial_log_begin();
+        serial_log_print(line);
+        for (uint32_t bucket : phase.histogram) {
+            FORMAT(line, " ", bucket);
+            serial_log_print(line);
+        }
+        serial_log_print("\r\n");
+        serial_log_end();
+    }
+}
+
+static void print_boot_profile() {
+    char line[64];
+    for (int i = 0; i < NUMBER_OF_TELEMETRY_BOOT_PHASES; i++) {
+        struct telemetry_boot_mark mark;
+        if (telemetry_get_boot_mark((telemetry_boot_phase_t) i, &mark)) {
+            FORMAT(line, "boot ", telemetry_boot_phase_name((telemetry_boot_phase_t) i),
+                   " at_us ", mark.at_us, " took_us ", mark.duration_us);
+        } else {
+            FORMAT(line, "boot ", telemetry_boot_phase_name((telemetry_boot_phase_t) i), " not_reached");
+        }
+        serial_log_line(line);
+    }
+}
+
+static void print_clock_residency() {
+    struct clock_residency residency[MAXIMUM_CLOCK_LEVELS];
+    unsigned int count = get_clock_residency(residency, MAXIMUM_CLOCK_LEVELS);
+    char line[80];
+    FORMAT(line, "clock_khz ", get_clock_khz());
+    serial_log_line(line);
+    for (unsigned int i = 0; i < count; i++) {
+        FORMAT(line, "clock ", residency[i].khz, " khz entries ", residency[i].entries,
+               " ms ", (uint32_t) (residency[i].total_us / 1000));
+        serial_log_line(line);
+    }
+}
+
+/*
+ * An audit range is read a character at a time, as it arrives, and then sent
+ * a frame at a time, as the serial log has room, so that neither waits.
+ */
+static struct {
+    bool is_reading_range;
+    bool is_sending;
+    bool is_reading_last;
+    bool has_last;
+    uint32_t next_sequence_number;
+    uint32_t last_sequence_number;
+} audit_request;
+
+static void begin_audit_request() {
+    audit_request.is_reading_range = true;
+    audit_request.is_sending = false;
+    audit_request.is_reading_last = false;
+    audit_request.has_last = false;
+    audit_request.next_sequence_number = 0;
+    audit_request.last_sequence_number = 0;
+}
+
+// Returns whether the character belonged to the range
+static bool read_audit_range(int character) {
+    if (!audit_request.is_reading_range) {
+        return false;
+    }
+    if (character >= '0' && character <= '9') {
+        uint32_t *bound = audit_request.is_reading_last ? &audit_request.last_sequence_number
+                                                        : &audit_request.next_sequence_number;
+        *bound = *bound * 10 + (character - '0');
+        audit_request.has_last |= audit_request.is_reading_last;
+        return true;
+    }
+    if (character == '-' && !audit_request.is_reading_last) {
+        audit_request.is_reading_last = true;
+        return true;
+    }
+    audit_request.is_reading_range = false;
+    audit_request.is_sending = true;
+    // a line ending finishes the range; any other character is the next command
+    return character == '\r' || character == '\n';
+}
+
+static void send_audit_records() {
+    static struct audit_record records[AUDIT_RECORDS_PER_FRAME];
+    uint16_t constexpr header_length = 8;
+    if (!audit_request.is_sending
+        || serial_log_room() < 9 + header_length + sizeof(records)) {
+        return;
+    }
+    uint16_t count = (uint16_t) audit_log_read(audit_request.next_sequence_number, records, AUDIT_RECORDS_PER_FRAME);
+    while (count > 0 && audit_request.has_last
+           && records[count - 1].sequence_number > audit_request.last_sequence_number) {
+        count--;
+    }
+    FrameWriter frame('A', header_length + count * sizeof(struct audit_record));
+    uint8_t header[] = {AUDIT_FORMAT_VERSION, (uint8_t) sizeof(struct audit_record),
+                        (uint8_t) count, (uint8_t) (count >> 8)};
+    frame.write(header, sizeof(header));
+    frame.write_little_endian(audit_log_next_sequence_number(), 4);
+    frame.write(records, count * sizeof(struct audit_record));
+    frame.finish();
+    if (count == 0) {
+        // the empty frame ends the response
+        audit_request.is_sending = false;
+    } else {
+        audit_request.next_sequence_number = records[count - 1].sequence_number + 1;
+    }
+}
+
+#if ISR_PROFILING
+
+static void print_isr_timing(char const *label, struct isr_timing const *timing) {
+    char line[64];
+    FORMAT(line, " ", label, " min ", timing->minimum, " max ", timing->maximum, " histogram");
+    serial_log_print(line);
+    for (uint32_t bucket : timing->histogram) {
+        FORMAT(line, " ", bucket);
+        serial_log_print(line);
+    }
+}
+
+static void print_isr_profiles() {
+    static struct isr_profile_report reports[32 + MAXIMUM_NUMBER_OF_TIMERS + MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS];
+    unsigned int count = get_isr_profiles(reports, sizeof(reports) / sizeof(reports[0]));
+    for (unsigned int i = 0; i < count; i++) {
+        char line[56];
+        char const *source = (reports[i].source == 'P') ? "pin" : (reports[i].source == 'F') ? "flash_safe_timer" : "timer";
+        FORMAT(line, "isr ", source, " ", reports[i].number,
+               " count ", reports[i].execution_cycles.count);
+        serial_log_begin();
+        serial_log_print(line);
+        print_isr_timing("arrival_us", &reports[i].arrival_us);
+        print_isr_timing("execution_cycles", &reports[i].execution_cycles);
+        serial_log_print("\r\n");
+        serial_log_end();
+    }
+}
+
+#endif //ISR_PROFILING
+
+/*
+ * Sends as much of the serial log as the port can take without blocking. With
+ * no host attached, nothing is sent and the log's policy decides what to keep.
+ */
+static void drain_serial_log() {
+    if (!Serial) {
+        return;
+    }
+    int room = Serial.availableForWrite();
+    while (room > 0) {
+        void const *data;
+        size_t length = serial_log_peek(&data);
+        if (length == 0) {
+            return;
+        }
+        if (length > (size_t) room) {
+            length = (size_t) room;
+        }
+        size_t sent = Serial.write((uint8_t const *) data, length);
+        serial_log_consume(sent);
+        if (sent < length) {
+            return;
+        }
+        room -= (int) sent;
+    }
+}
+
+void service_diagnostics(void) {
+    telemetry_mark_loop();
+    while (Serial.available() > 0) {
+        int character = Serial.read();
+        if (read_audit_range(character)) {
+            continue;
+        }
+        switch (character) {
+            case 'T':
+                send_trace();
+                break;
+            case 'S':
+                send_telemetry();
+                break;
+            case 's':
+                print_telemetry();
+                break;
+            case 'B':
+                print_boot_profile();
+                break;
+            case 'C':
+                print_clock_residency();
+                break;
+            case 'A':
+                begin_audit_request();
+                break;
+            case 'Z':
+                telemetry_clear();
+                clear_clock_residency();
+#if ISR_PROFILING
+                clear_isr_profiles();
+#endif
+                break;
+#if ISR_PROFILING
+            case 'I':
+                print_isr_profiles();
+                break;
+#endif
+            default:
+                // ignore unknown commands and line endings
+                break;
+        }
+    }
+    send_audit_records();
+    drain_serial_log();
+}
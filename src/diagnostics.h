@@ -0,0 +1,85 @@
+/**************************************************************************/
+/**
+ *
+ * @file diagnostics.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Single-character commands, received on the Serial port, that stream
+ *      diagnostic data back over the Serial port.
+ *
+ * Commands:
+ * <ul>
+ * <li> <code>T</code> -- send the input trace as one binary frame
+ * <li> <code>S</code> -- send a telemetry snapshot as one binary frame
+ * <li> <code>s</code> -- send a telemetry snapshot as text
+ * <li> <code>B</code> -- send the boot profile as text: for each boot phase,
+ *      when it ended and how long it took since the phase before it
+ * <li> <code>C</code> -- send the current system clock, and the time spent at
+ *      each clock, as text
+ * <li> <code>A</code> -- send the audit log as binary frames; it may be
+ *      followed by a range of sequence numbers and must end with a line
+ *      ending, as in <code>A\n</code> (every record), <code>A120\n</code>
+ *      (from record 120), or <code>A120-180\n</code>
+ * <li> <code>Z</code> -- clear the telemetry (and the clock residency and the
+ *      ISR profiles) and start a new window
+ * <li> <code>I</code> -- send the ISR profiles as text; only when built with
+ *      <code>-D ISR_PROFILING=1</code>
+ * </ul>
+ *
+ * Responses are queued in the serial log (see serial-log.h) rather than
+ * written to the port. Every call to <code>service_diagnostics()</code> sends
+ * as much of the log as the port will take without blocking, and marks one
+ * pass of <code>loop()</code> for the telemetry.
+ *
+ * Binary frames begin with the bytes <code>0xA5 0x5A</code>, then a one-byte
+ * frame type and a two-byte little-endian payload length, then the payload,
+ * and end with the little-endian CRC-32 of everything after the two sync
+ * bytes.
+ *
+ * The trace frame (type <code>'T'</code>) carries a one-byte format version,
+ * the one-byte size of an event, the four-byte count of events recorded since
+ * boot, a two-byte count of events in the frame, and then the events, oldest
+ * first, each laid out as <code>struct trace_event</code>.
+ *
+ * The telemetry frame (type <code>'S'</code>) carries a one-byte format
+ * version, the number of counters, phases, and histogram buckets (one byte
+ * each), and the four-byte window length in microseconds. Then come the
+ * four-byte counters, in the order of <code>telemetry_counter_t</code>, and
+ * then, for each phase in the order of <code>telemetry_phase_t</code>, its
+ * four-byte count, eight-byte total, four-byte maximum, and four-byte
+ * histogram buckets. All fields are little-endian.
+ *
+ * The audit frames (type <code>'A'</code>) each carry a one-byte format
+ * version, the one-byte size of a record, a two-byte count of records in the
+ * frame, the four-byte sequence number that the next record will get, and
+ * then the records, oldest first, each laid out as
+ * <code>struct audit_record</code>. The records are sent a frame at a time as
+ * the serial log makes room for them, and a frame with no records ends the
+ * response.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_DIAGNOSTICS_H
+#define COMBOLOCK_DIAGNOSTICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Executes any command waiting on the Serial port. Does not wait for input.
+ */
+void service_diagnostics(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_DIAGNOSTICS_H
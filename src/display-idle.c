@@ -0,0 +1,50 @@
+/**************************************************************************/
+/**
+ *
+ * @file display-idle.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief display-idle.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+// clang-format off
+#include <CowPi.h>
+#include "display-idle.h"
+#include "input-activity.h"
+#include "memory-map.h"
+// clang-format on
+
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *) (TIMER_BASE_ADDRESS);
+
+static uint32_t idle_timeout_us = DISPLAY_IDLE_TIMEOUT_uS;
+static uint32_t input_changes_seen = 0;
+static uint32_t active_since_us = 0;
+// once the timeout has lapsed, it stays lapsed until the next activity, so that the timer wrapping around cannot wake the display
+static bool has_lapsed = false;
+
+bool display_may_sleep(lock_mode_t mode) {
+    uint32_t now = timer->raw_lower_word;
+    uint32_t changes = count_input_changes();
+    if (changes != input_changes_seen || mode != LOCKED) {
+        input_changes_seen = changes;
+        active_since_us = now;
+        has_lapsed = false;
+    } else if (!has_lapsed && idle_timeout_us != 0 && now - active_since_us >= idle_timeout_us) {
+        has_lapsed = true;
+    }
+    return has_lapsed;
+}
+
+void set_display_idle_timeout(uint32_t timeout_us) {
+    idle_timeout_us = timeout_us;
+    // restart the idle time, and wake the display if it is asleep
+    note_input_activity();
+}
@@ -0,0 +1,62 @@
+/**************************************************************************/
+/**
+ *
+ * @file display-idle.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Decides when the display may be switched off because no one is
+ *      using the lock.
+ *
+ * Only a locked lock lets the display sleep, and only once there has been no
+ * input for the idle timeout. An unlocked lock, a lock being changed, and
+ * above all an alarmed lock are showing something that someone needs to see,
+ * so in those modes the display stays on, and the idle time starts over when
+ * the lock is locked again. The next input wakes the display.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_DISPLAY_IDLE_H
+#define COMBOLOCK_DISPLAY_IDLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lock-bank.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DISPLAY_IDLE_TIMEOUT_uS
+#define DISPLAY_IDLE_TIMEOUT_uS (60000000uL) // without input for this long, a locked lock's display is switched off
+#endif
+
+/**
+ * Applies the idle policy. Called by <code>refresh_display()</code>.
+ *
+ * @param mode The lock's mode
+ * @return <code>true</code> if the display may be switched off;
+ *      <code>false</code> if it must be on
+ */
+bool display_may_sleep(lock_mode_t mode);
+
+/**
+ * Sets how long a locked lock's display stays on without input. The default
+ * is <code>DISPLAY_IDLE_TIMEOUT_uS</code>.
+ *
+ * @param timeout_us The idle time, in microseconds, after which the display is
+ *      switched off; 0 keeps the display on
+ */
+void set_display_idle_timeout(uint32_t timeout_us);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_DISPLAY_IDLE_H
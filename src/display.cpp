@@ -26,7 +26,13 @@
 #include <CowPi.h>
 #include <CowPi_stdio.h>
 #include <stdlib.h>
+#include "clock-governor.h"
 #include "display.h"
+#include "display-idle.h"
+#include "format.h"
+#include "lock-bank.h"
+#include "serial-log.h"
+#include "telemetry.h"
 
 #if __has_include(<OneBitDisplay.h>)
 #define ONEBIT
@@ -52,6 +58,11 @@
 #define CORELIBRARY ("unknown")
 #endif
 
+#ifndef DISPLAY_I2C_INSTANCE
+#define DISPLAY_I2C_INSTANCE (0)    // Wire, on GP4 and GP5
+#endif
+#define DISPLAY_I2C_BAUD_HZ (400000L)
+
 
 static int column_count;
 static int row_count;
@@ -59,6 +70,9 @@ static int character_width;
 static int character_height;
 
 static inline void library_specific_initialize_display(int number_of_columns);
+static inline void library_specific_clear_frame(void);
+static inline void library_specific_power_display(bool is_on);
+static bool display_is_awake(void);
 
 static char rows[8][23] = {{0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}};
 
@@ -136,7 +150,9 @@ static OBDISP display;
 static int font;
 
 static inline void library_specific_initialize_display(int number_of_columns) {
-    obdI2CInit(&display, OLED_128x64, -1, 0, 0, 1, -1, -1, -1, 400000L);
+    obdI2CInit(&display, OLED_128x64, -1, 0, 0, 1, -1, -1, -1, DISPLAY_I2C_BAUD_HZ);
+    // the library sets the rate only here, and the I2C block times it from clk_sys
+    keep_i2c_baud_rate(DISPLAY_I2C_INSTANCE, DISPLAY_I2C_BAUD_HZ);
     obdSetBackBuffer(&display, backbuffer);
     switch (number_of_columns) {
         case 21:
@@ -152,13 +168,12 @@ static inline void library_specific_initialize_display(int number_of_columns) {
             font = FONT_16x16;
             break;
         default:
-            fprintf(stderr, "no font available");
+            serial_log_line("no font available");
     }
 }
 
-void clear_display(void) {
+static inline void library_specific_clear_frame(void) {
     obdFill(&display, OBD_WHITE, 0);
-    refresh_display();
 }
 
 void draw_logo() {
@@ -166,11 +181,24 @@ void draw_logo() {
     refresh_display();
 }
 
+static inline void library_specific_power_display(bool is_on) {
+    obdPower(&display, is_on);
+}
+
 void refresh_display(void) {
+    if (!display_is_awake()) {
+        return;
+    }
+    raise_clock_for_transfer();
+    uint32_t start_time = telemetry_start();
     for (int row = 0; row < row_count; ++row) {
         obdWriteString(&display, 0, 0, character_height * row, (char *) rows[row], font, OBD_BLACK, 0);
     }
+    telemetry_finish(TELEMETRY_DISPLAY_FORMAT, start_time);
+    start_time = telemetry_start();
     obdDumpBuffer(&display, backbuffer);
+    telemetry_finish(TELEMETRY_DISPLAY_FLUSH, start_time);
+    telemetry_note_frame_shown();
 }
 
 
@@ -246,14 +274,14 @@ static uint8_t logo[] = {
 static Adafruit_SSD1306 display(128, 64);
 
 static inline void library_specific_initialize_display(int number_of_columns) {
+    // the library sets Wire's clock at the start of every transfer, so the bus keeps its rate across clock switches
     display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
     display.setTextSize((number_of_columns <= 10) ? 2 : 1);
     display.setTextColor(SSD1306_WHITE);
 }
 
-void clear_display(void) {
+static inline void library_specific_clear_frame(void) {
     display.clearDisplay();
-    refresh_display();
 }
 
 void draw_logo() {
@@ -261,37 +289,77 @@ void draw_logo() {
     display.display();
 }
 
+static inline void library_specific_power_display(bool is_on) {
+    display.ssd1306_command(is_on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+}
+
 void refresh_display(void) {
+    if (!display_is_awake()) {
+        return;
+    }
+    raise_clock_for_transfer();
+    uint32_t start_time = telemetry_start();
     display.clearDisplay();
     for (int row = 0; row < row_count; ++row) {
         display.setCursor((int16_t) ((128 - (character_width * column_count)) / 2), (int16_t) (character_height * row));
         display.print(rows[row]);
     }
+    telemetry_finish(TELEMETRY_DISPLAY_FORMAT, start_time);
+    start_time = telemetry_start();
     display.display();
+    telemetry_finish(TELEMETRY_DISPLAY_FLUSH, start_time);
+    telemetry_note_frame_shown();
 }
 
 
 #endif
 
 
+static bool is_asleep = false;
+
+// applies the idle policy, switching the panel off or on, and reports whether it is on
+static bool display_is_awake(void) {
+    bool may_sleep = display_may_sleep(get_bank_mode());
+    if (may_sleep != is_asleep) {
+        // the panel keeps its contents while it is off, so there is nothing to restore when it wakes
+        library_specific_power_display(!may_sleep);
+        is_asleep = may_sleep;
+    }
+    return !is_asleep;
+}
+
+
 void initialize_display(int number_of_columns) {
     record_build_timestamp(__FILE__, __DATE__, __TIME__);
     if ((number_of_columns != 8) && (number_of_columns != 10) && (number_of_columns != 16) && (number_of_columns != 21)) {
-        fprintf(stderr, "number of columns cannot be %d.\n", number_of_columns);
+        char message[40];
+        FORMAT(message, "number of columns cannot be ", number_of_columns, ".");
+        serial_log_line(message);
     }
     column_count = number_of_columns;
     row_count = (number_of_columns <= 10) ? 4 : 8;
     character_width = (number_of_columns <= 10) ? 12 : 6;
     character_height = (number_of_columns <= 10) ? 16 : 8;
     library_specific_initialize_display(number_of_columns);
+#if FAST_BOOT
+    // every refresh sends a whole frame, so the first one clears the panel, after the lock is ready
+    library_specific_clear_frame();
+#else
     clear_display();
+#endif
+}
+
+void clear_display(void) {
+    library_specific_clear_frame();
+    refresh_display();
 }
 
 void display_string(int row, char const string[]) {
     static char buffer[23] = {"                      "};
+    telemetry_note_display_change();
     size_t string_length = strlen(string);
     if (0 <= row && row < row_count) {
-        sprintf(buffer, "%-*s", column_count, string);
+        FORMAT(buffer, left_aligned_field(string, column_count));
     }
     if (string[string_length - 1] == '\n') {
         buffer[string_length - 1] = '\0';
@@ -303,25 +371,34 @@ void display_string(int row, char const string[]) {
 }
 
 
+// shows a message and echoes it, without any trailing newline, to the Serial Monitor
+static void show_and_log(int row, char const message[]) {
+    display_string(row, message);
+    serial_log_begin();
+    serial_log_append(message, strcspn(message, "\n"));
+    serial_log_print("\r\n");
+    serial_log_end();
+}
+
 void print_versions(void) {
     char message[22];
     if (column_count >= 16) {
-        sprintf(message, "gcc %*d.%d", column_count - 8, __GNUC__, __GNUC_MINOR__);
-        display_string(0, message);
-        sprintf(message, "Core %*s", column_count - 5, CORELIBRARY);
-        display_string(1, message);
-        sprintf(message, "CowPi %*s", column_count - 6, COWPI_VERSION);
-        display_string(2, message);
-        sprintf(message, "CowPi_stdio%*s", column_count - 11, COWPI_STDIO_VERSION);
-        display_string(3, message);
+        FORMAT(message, "gcc ", decimal_field(__GNUC__, column_count - 8), ".", __GNUC_MINOR__);
+        show_and_log(0, message);
+        FORMAT(message, "Core ", right_aligned_field(CORELIBRARY, column_count - 5));
+        show_and_log(1, message);
+        FORMAT(message, "CowPi ", right_aligned_field(COWPI_VERSION, column_count - 6));
+        show_and_log(2, message);
+        FORMAT(message, "CowPi_stdio", right_aligned_field(COWPI_STDIO_VERSION, column_count - 11));
+        show_and_log(3, message);
         refresh_display();
     } else {
-        sprintf(message, "gcc%*d", column_count - 3, __GNUC__);
-        display_string(0, message);
-        sprintf(message, "CowPi%*.*s", column_count - 5, column_count - 5, COWPI_VERSION);
-        display_string(1, message);
-        sprintf(message, "stdio%*.*s", column_count - 5, column_count - 5, COWPI_STDIO_VERSION);
-        display_string(2, message);
+        FORMAT(message, "gcc", decimal_field(__GNUC__, column_count - 3));
+        show_and_log(0, message);
+        FORMAT(message, "CowPi", clipped_right_aligned_field(COWPI_VERSION, column_count - 5));
+        show_and_log(1, message);
+        FORMAT(message, "stdio", clipped_right_aligned_field(COWPI_STDIO_VERSION, column_count - 5));
+        show_and_log(2, message);
         refresh_display();
     }
 }
@@ -369,7 +446,7 @@ void record_build_timestamp(const char *filename, const char *date, const char *
         strncpy(records[number_of_records].filename, filename, 22);
     }
     strncpy(records[number_of_records].date, date + 7, 4);                  // year
-    sprintf(records[number_of_records].date + 4, "%02d", month);            // month
+    FORMAT(records[number_of_records].date + 4, zero_padded_field(month, 2));   // month
     records[number_of_records].date[6] = date[4] == ' ' ? '0' : date[4];    // day (tens place)
     records[number_of_records].date[7] = date[5];                           // day (ones place)
     records[number_of_records].date[8] = '\0';
@@ -390,43 +467,44 @@ void record_build_timestamp(const char *filename, const char *date, const char *
 void print_build_timestamps(bool only_most_recent) {
     // sort the records, with the most-recent timestamp first
     qsort(records, number_of_records, sizeof(struct build_timestamp), compare_build_timestamps);
-    char timestamp[17];
+    char timestamp[22];
     if (only_most_recent) {
         switch (column_count) {
             case 16:
             case 21:
 //                sprintf(timestamp, "%8.8s/%6.6s\n", records[0].date, records[0].time);
-                sprintf(timestamp, "%8.8s/%4.4s\n", records[0].date, records[0].time);
+                FORMAT(timestamp, clipped_right_aligned_field(records[0].date, 8), "/",
+                       clipped_right_aligned_field(records[0].time, 4), "\n");
                 break;
             case 10:
-                sprintf(timestamp, "%6.6s%4.4s\n", records[0].date + 2, records[0].time);
+                FORMAT(timestamp, clipped_right_aligned_field(records[0].date + 2, 6),
+                       clipped_right_aligned_field(records[0].time, 4), "\n");
                 break;
             case 8:
-                sprintf(timestamp, "%4.4s%4.4s\n", records[0].date + 4, records[0].time);
+                FORMAT(timestamp, clipped_right_aligned_field(records[0].date + 4, 4),
+                       clipped_right_aligned_field(records[0].time, 4), "\n");
                 break;
             default:
-                sprintf(timestamp, "ERROR");
+                FORMAT(timestamp, "ERROR");
         }
-        display_string(row_count - 1, timestamp);
+        show_and_log(row_count - 1, timestamp);
     } else {
         for (int i = 0; i < min(number_of_records, row_count); i++) {
             switch (column_count) {
                 case 16:
                 case 21:
-                    sprintf(timestamp, "%-*.*s%6s",
-                            column_count - 6, column_count - 6,
-                            records[i].filename, records[i].time);
+                    FORMAT(timestamp, clipped_left_aligned_field(records[i].filename, column_count - 6),
+                           right_aligned_field(records[i].time, 6));
                     break;
                 case 10:
                 case 8:
-                    sprintf(timestamp, "%-*.*s%4.4s",
-                            column_count - 4, column_count - 4,
-                            records[i].filename, records[i].time);
+                    FORMAT(timestamp, clipped_left_aligned_field(records[i].filename, column_count - 4),
+                           clipped_right_aligned_field(records[i].time, 4));
                     break;
                 default:
-                    sprintf(timestamp, "ERROR");
+                    FORMAT(timestamp, "ERROR");
             }
-            display_string(i, timestamp);
+            show_and_log(i, timestamp);
         }
     }
     refresh_display();
@@ -441,6 +519,6 @@ void count_visits(int row) {
             rows[row][i] = ' ';
         }
     }
-    sprintf(rows[row] + counter_position, "%02X", ++counters[row]);
-    refresh_display();
+    FORMAT(rows[row] + counter_position, hex_field(++counters[row], 2));
+    // shown by the next refresh; refreshing here would send every frame twice
 }
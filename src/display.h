@@ -30,6 +30,9 @@
 #ifndef COWPI_DISPLAY_H
 #define COWPI_DISPLAY_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,6 +44,9 @@ extern "C" {
  * If the number of columns of text is 10 or fewer, however, then the display
  * module will be configured for four rows of text.
  *
+ * The display is cleared. When built with <code>-D FAST_BOOT=1</code>, only
+ * the frame buffer is cleared, and the panel is cleared by the first refresh.
+ *
  * @param number_of_columns The number of character columns to be used.
  *      Valid values are 8, 10, 16, and 21.
  */
@@ -71,6 +77,12 @@ void display_string(int row, char const string[]);
 
 /**
  * Updates the display with any buffered strings.
+ *
+ * If <code>display_may_sleep()</code> allows, the display is switched off
+ * instead, and refreshes do nothing until it is switched back on. Strings
+ * placed while the display is off are shown when it wakes.
+ *
+ * @see display-idle.h
  */
 void refresh_display(void);
 
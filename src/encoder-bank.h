@@ -0,0 +1,58 @@
+/**************************************************************************/
+/**
+ *
+ * @file encoder-bank.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief What the rotary encoder code makes available beyond the starter
+ *      rotary-encoder.h: each lock's own dial, and sampling the wipers while
+ *      flash is stalled.
+ *
+ * The starter <code>get_direction()</code> reads the first lock's dial.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_ENCODER_BANK_H
+#define COMBOLOCK_ENCODER_BANK_H
+
+#include <stdint.h>
+#include "rotary-encoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Like <code>get_direction()</code>, for any lock in the bank.
+ *
+ * @param lock The lock whose dial is read
+ * @return The direction that the dial last turned, or
+ *      <code>STATIONARY</code> if it has not turned since the last call
+ */
+direction_t get_direction_of(uint8_t lock);
+
+/**
+ * Starts recording each change of the wipers from the flash-safe sampler.
+ * Called just before flash is erased or programmed, while the pin interrupt
+ * is blocked.
+ */
+void begin_sampling_wipers();
+
+/**
+ * Stops the sampler and decodes the changes it recorded. Called once the
+ * flash operation ends, before the pin interrupt is unblocked.
+ */
+void finish_sampling_wipers();
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_ENCODER_BANK_H
@@ -0,0 +1,44 @@
+/**************************************************************************/
+/**
+ *
+ * @file flash-storage.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief flash-storage.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+// clang-format off
+#include <CowPi.h>
+#include <hardware/flash.h>
+#include "flash-storage.h"
+#include "interrupt_support.h"
+#include "encoder-bank.h"
+// clang-format on
+
+uint8_t const *flash_storage_read_pointer(uint32_t offset) {
+    return (uint8_t const *) (XIP_BASE + offset);
+}
+
+void flash_storage_erase_sector(uint32_t offset) {
+    flash_stall_t stall = begin_flash_stall();
+    begin_sampling_wipers();
+    flash_range_erase(offset, FLASH_STORAGE_SECTOR_SIZE);
+    finish_sampling_wipers();
+    end_flash_stall(stall);
+}
+
+void flash_storage_program_page(uint32_t offset, uint8_t const data[]) {
+    flash_stall_t stall = begin_flash_stall();
+    begin_sampling_wipers();
+    flash_range_program(offset, data, FLASH_STORAGE_PAGE_SIZE);
+    finish_sampling_wipers();
+    end_flash_stall(stall);
+}
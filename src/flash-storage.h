@@ -0,0 +1,77 @@
+/**************************************************************************/
+/**
+ *
+ * @file flash-storage.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Low-level access to the sectors at the end of the RP2040's flash
+ *      that are reserved for data the lock must keep across power cycles.
+ *
+ * The RP2040 executes from flash, so erasing or programming flash stalls
+ * every instruction fetch from it. The functions here run the flash operation
+ * with every interrupt blocked except the flash-safe timers, which run from
+ * RAM: the servo's tick, which keeps the servo signal going, and a sampler
+ * that records each change of the encoders' wipers. The samples are decoded
+ * once the operation ends, before the encoder's pin interrupts are unblocked,
+ * so no detent is lost to the stall.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_FLASH_STORAGE_H
+#define COMBOLOCK_FLASH_STORAGE_H
+
+#include <stdint.h>
+
+#define FLASH_STORAGE_PAGE_SIZE (256)
+#define FLASH_STORAGE_SECTOR_SIZE (4096)
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+// the last two sectors hold the configuration store
+#define CONFIG_STORE_OFFSET (PICO_FLASH_SIZE_BYTES - 2 * FLASH_STORAGE_SECTOR_SIZE)
+#define CONFIG_STORE_NUMBER_OF_SECTORS (2)
+
+// the sectors just below it hold the audit log
+#ifndef AUDIT_LOG_NUMBER_OF_SECTORS
+#define AUDIT_LOG_NUMBER_OF_SECTORS (8)
+#endif
+#define AUDIT_LOG_OFFSET (CONFIG_STORE_OFFSET - AUDIT_LOG_NUMBER_OF_SECTORS * FLASH_STORAGE_SECTOR_SIZE)
+
+/**
+ * Provides a pointer through which flash contents can be read.
+ *
+ * @param offset The offset from the start of flash
+ * @return A pointer into the memory-mapped flash
+ */
+uint8_t const *flash_storage_read_pointer(uint32_t offset);
+
+/**
+ * Erases one sector, leaving every byte in it <code>0xFF</code>.
+ * The caller stalls for tens of milliseconds.
+ *
+ * @param offset The offset of the sector from the start of flash;
+ *      must be a multiple of <code>FLASH_STORAGE_SECTOR_SIZE</code>
+ */
+void flash_storage_erase_sector(uint32_t offset);
+
+/**
+ * Programs one page. Programming can only clear bits, so bytes that are
+ * <code>0xFF</code> in <code>data</code> leave the corresponding flash bytes
+ * as they were; this allows a page to be filled a few records at a time.
+ *
+ * @param offset The offset of the page from the start of flash;
+ *      must be a multiple of <code>FLASH_STORAGE_PAGE_SIZE</code>
+ * @param data <code>FLASH_STORAGE_PAGE_SIZE</code> bytes to be programmed
+ */
+void flash_storage_program_page(uint32_t offset, uint8_t const data[]);
+
+#endif //COMBOLOCK_FLASH_STORAGE_H
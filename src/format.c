@@ -0,0 +1,111 @@
+/**************************************************************************/
+/**
+ *
+ * @file format.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief format.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <string.h>
+#include "format.h"
+
+#define MAXIMUM_DECIMAL_DIGITS (10)
+
+// the Cortex-M0+ has no divide instruction, so digits are peeled off by subtracting powers of ten
+static uint32_t const powers_of_ten[MAXIMUM_DECIMAL_DIGITS] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static char const hex_digits[] = "0123456789ABCDEF";
+
+static unsigned int count_decimal_digits(uint32_t value) {
+    unsigned int digits = 1;
+    while (digits < MAXIMUM_DECIMAL_DIGITS && value >= powers_of_ten[digits]) {
+        digits++;
+    }
+    return digits;
+}
+
+static char *pad_to_width(char *cursor, unsigned int length, unsigned int width, char pad) {
+    while (length < width) {
+        *cursor++ = pad;
+        length++;
+    }
+    return cursor;
+}
+
+static char *write_decimal_digits(char *cursor, uint32_t value, unsigned int digits) {
+    for (int i = (int) digits - 1; i >= 0; i--) {
+        char digit = '0';
+        while (value >= powers_of_ten[i]) {
+            value -= powers_of_ten[i];
+            digit++;
+        }
+        *cursor++ = digit;
+    }
+    *cursor = '\0';
+    return cursor;
+}
+
+char *format_unsigned(char *cursor, uint32_t value, unsigned int width, char pad) {
+    unsigned int digits = count_decimal_digits(value);
+    cursor = pad_to_width(cursor, digits, width, pad);
+    return write_decimal_digits(cursor, value, digits);
+}
+
+char *format_signed(char *cursor, int32_t value, unsigned int width, char pad) {
+    if (value >= 0) {
+        return format_unsigned(cursor, (uint32_t) value, width, pad);
+    }
+    // negate as unsigned, so that INT32_MIN does not overflow
+    uint32_t magnitude = 0u - (uint32_t) value;
+    unsigned int digits = count_decimal_digits(magnitude);
+    if (pad == '0') {
+        *cursor++ = '-';
+        cursor = pad_to_width(cursor, digits + 1, width, '0');
+    } else {
+        cursor = pad_to_width(cursor, digits + 1, width, pad);
+        *cursor++ = '-';
+    }
+    return write_decimal_digits(cursor, magnitude, digits);
+}
+
+char *format_hex(char *cursor, uint32_t value, unsigned int width) {
+    unsigned int digits = 1;
+    while (digits < 8 && (value >> (4 * digits)) != 0) {
+        digits++;
+    }
+    cursor = pad_to_width(cursor, digits, width, '0');
+    for (int i = (int) digits - 1; i >= 0; i--) {
+        *cursor++ = hex_digits[(value >> (4 * i)) & 0xF];
+    }
+    *cursor = '\0';
+    return cursor;
+}
+
+char *format_string(char *cursor, char const *string, unsigned int width, unsigned int maximum_length,
+                    bool is_left_aligned) {
+    unsigned int length = 0;
+    while (length < maximum_length && string[length] != '\0') {
+        length++;
+    }
+    if (!is_left_aligned) {
+        cursor = pad_to_width(cursor, length, width, ' ');
+    }
+    memcpy(cursor, string, length);
+    cursor += length;
+    if (is_left_aligned) {
+        cursor = pad_to_width(cursor, length, width, ' ');
+    }
+    *cursor = '\0';
+    return cursor;
+}
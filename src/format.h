@@ -0,0 +1,283 @@
+/**************************************************************************/
+/**
+ *
+ * @file format.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Small replacements for <code>sprintf()</code>: fixed-width decimal
+ *      and hexadecimal integers and padded strings, written into the caller's
+ *      buffer without allocating.
+ *
+ * Each writer takes a cursor into the buffer, writes its characters and a
+ * terminating NUL there, and returns a cursor to that NUL, so that writers
+ * can be chained and the buffer always holds a string. Like
+ * <code>sprintf()</code>, they do not know the buffer's size; the caller must
+ * provide room for the widest output.
+ *
+ * <code>FORMAT(buffer, piece, ...)</code> writes up to ten pieces in one
+ * expression. A piece is a string, an integer of up to 32 bits (written in
+ * decimal with no padding), or a field built by one of the
+ * <code>..._field()</code> functions below. For example,
+ * <code>FORMAT(buffer, "CW:", decimal_field(count, 2))</code> does what
+ * <code>sprintf(buffer, "CW:%2d", count)</code> does. The type of each piece
+ * chooses its writer at compile time, and a piece of any other type is a
+ * compile-time error. In C, a character constant such as <code>'-'</code> is
+ * an <code>int</code> and is written as a number, so write <code>"-"</code>
+ * instead; C++ rejects a <code>char</code> piece.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_FORMAT_H
+#define COMBOLOCK_FORMAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Writes an unsigned integer in decimal, right-aligned in a field.
+ *
+ * @param cursor Where to write
+ * @param value The integer
+ * @param width The field's minimum width; a wider number is not truncated
+ * @param pad The character that fills the field to the left of the number,
+ *      usually <code>' '</code> or <code>'0'</code>
+ * @return The cursor after the written characters, at the terminating NUL
+ */
+char *format_unsigned(char *cursor, uint32_t value, unsigned int width, char pad);
+
+/**
+ * Writes a signed integer in decimal, right-aligned in a field. The sign, if
+ * any, precedes zero-padding and follows space-padding, as with
+ * <code>printf()</code>.
+ *
+ * @param cursor Where to write
+ * @param value The integer
+ * @param width The field's minimum width, counting the sign
+ * @param pad <code>' '</code> or <code>'0'</code>
+ * @return The cursor after the written characters, at the terminating NUL
+ */
+char *format_signed(char *cursor, int32_t value, unsigned int width, char pad);
+
+/**
+ * Writes an unsigned integer in uppercase hexadecimal, zero-padded to a
+ * minimum width.
+ *
+ * @param cursor Where to write
+ * @param value The integer
+ * @param width The minimum number of digits
+ * @return The cursor after the written characters, at the terminating NUL
+ */
+char *format_hex(char *cursor, uint32_t value, unsigned int width);
+
+/**
+ * Copies at most <code>maximum_length</code> characters of a string, padded
+ * with spaces to a minimum width.
+ *
+ * @param cursor Where to write
+ * @param string The string
+ * @param width The field's minimum width
+ * @param maximum_length The most characters of <code>string</code> to copy
+ * @param is_left_aligned Whether the padding follows the string instead of
+ *      preceding it
+ * @return The cursor after the written characters, at the terminating NUL
+ */
+char *format_string(char *cursor, char const *string, unsigned int width, unsigned int maximum_length,
+                    bool is_left_aligned);
+
+#define FORMAT_UNLIMITED_LENGTH (0xFFFFu)
+
+/* ---- fields for FORMAT() ---- */
+
+struct format_integer_field {
+    int32_t value;
+    uint8_t width;
+    char pad;
+};
+
+struct format_hex_field {
+    uint32_t value;
+    uint8_t width;
+};
+
+struct format_string_field {
+    char const *string;
+    uint8_t width;
+    uint16_t maximum_length;
+    bool is_left_aligned;
+};
+
+// printf's "%*d": right-aligned, padded with spaces
+static inline struct format_integer_field decimal_field(int32_t value, unsigned int width) {
+    struct format_integer_field field = {value, (uint8_t) width, ' '};
+    return field;
+}
+
+// printf's "%0*d": padded with zeroes
+static inline struct format_integer_field zero_padded_field(int32_t value, unsigned int width) {
+    struct format_integer_field field = {value, (uint8_t) width, '0'};
+    return field;
+}
+
+// printf's "%0*X"
+static inline struct format_hex_field hex_field(uint32_t value, unsigned int width) {
+    struct format_hex_field field = {value, (uint8_t) width};
+    return field;
+}
+
+// printf's "%-*s"
+static inline struct format_string_field left_aligned_field(char const *string, unsigned int width) {
+    struct format_string_field field = {string, (uint8_t) width, FORMAT_UNLIMITED_LENGTH, true};
+    return field;
+}
+
+// printf's "%*s"
+static inline struct format_string_field right_aligned_field(char const *string, unsigned int width) {
+    struct format_string_field field = {string, (uint8_t) width, FORMAT_UNLIMITED_LENGTH, false};
+    return field;
+}
+
+// printf's "%-*.*s" with both numbers the same: exactly width characters
+static inline struct format_string_field clipped_left_aligned_field(char const *string, unsigned int width) {
+    struct format_string_field field = {string, (uint8_t) width, (uint16_t) width, true};
+    return field;
+}
+
+// printf's "%*.*s" with both numbers the same: exactly width characters
+static inline struct format_string_field clipped_right_aligned_field(char const *string, unsigned int width) {
+    struct format_string_field field = {string, (uint8_t) width, (uint16_t) width, false};
+    return field;
+}
+
+/* ---- one writer per type of piece ---- */
+
+static inline char *format_piece_string(char *cursor, char const *string) {
+    return format_string(cursor, string, 0, FORMAT_UNLIMITED_LENGTH, true);
+}
+
+static inline char *format_piece_signed(char *cursor, int32_t value) {
+    return format_signed(cursor, value, 0, ' ');
+}
+
+static inline char *format_piece_unsigned(char *cursor, uint32_t value) {
+    return format_unsigned(cursor, value, 0, ' ');
+}
+
+static inline char *format_piece_integer_field(char *cursor, struct format_integer_field field) {
+    return format_signed(cursor, field.value, field.width, field.pad);
+}
+
+static inline char *format_piece_hex_field(char *cursor, struct format_hex_field field) {
+    return format_hex(cursor, field.value, field.width);
+}
+
+static inline char *format_piece_string_field(char *cursor, struct format_string_field field) {
+    return format_string(cursor, field.string, field.width, field.maximum_length, field.is_left_aligned);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+
+static inline char *format_piece(char *cursor, char const *string) {
+    return format_piece_string(cursor, string);
+}
+
+static inline char *format_piece(char *cursor, signed char value) {
+    return format_piece_signed(cursor, value);
+}
+
+static inline char *format_piece(char *cursor, short value) {
+    return format_piece_signed(cursor, value);
+}
+
+static inline char *format_piece(char *cursor, int value) {
+    return format_piece_signed(cursor, value);
+}
+
+static inline char *format_piece(char *cursor, long value) {
+    return format_piece_signed(cursor, (int32_t) value);
+}
+
+static inline char *format_piece(char *cursor, unsigned char value) {
+    return format_piece_unsigned(cursor, value);
+}
+
+static inline char *format_piece(char *cursor, unsigned short value) {
+    return format_piece_unsigned(cursor, value);
+}
+
+static inline char *format_piece(char *cursor, unsigned int value) {
+    return format_piece_unsigned(cursor, value);
+}
+
+static inline char *format_piece(char *cursor, unsigned long value) {
+    return format_piece_unsigned(cursor, (uint32_t) value);
+}
+
+static inline char *format_piece(char *cursor, struct format_integer_field field) {
+    return format_piece_integer_field(cursor, field);
+}
+
+static inline char *format_piece(char *cursor, struct format_hex_field field) {
+    return format_piece_hex_field(cursor, field);
+}
+
+static inline char *format_piece(char *cursor, struct format_string_field field) {
+    return format_piece_string_field(cursor, field);
+}
+
+// C would write a char as a number; make the difference a compile-time error
+char *format_piece(char *cursor, char character) = delete;
+
+static inline char *format_pieces(char *cursor) {
+    return cursor;
+}
+
+template<typename First, typename... Rest>
+static inline char *format_pieces(char *cursor, First first, Rest... rest) {
+    return format_pieces(format_piece(cursor, first), rest...);
+}
+
+#define FORMAT(buffer, ...) format_pieces((buffer), __VA_ARGS__)
+
+#else
+
+#define FORMAT_PIECE(cursor, piece) _Generic((piece),                                               \
+        char *: format_piece_string, char const *: format_piece_string,                             \
+        signed char: format_piece_signed, short: format_piece_signed, int: format_piece_signed,     \
+        long: format_piece_signed,                                                                  \
+        unsigned char: format_piece_unsigned, unsigned short: format_piece_unsigned,                \
+        unsigned int: format_piece_unsigned, unsigned long: format_piece_unsigned,                  \
+        struct format_integer_field: format_piece_integer_field,                                    \
+        struct format_hex_field: format_piece_hex_field,                                            \
+        struct format_string_field: format_piece_string_field)((cursor), (piece))
+
+#define FORMAT_1(cursor, a) FORMAT_PIECE(cursor, a)
+#define FORMAT_2(cursor, a, ...) FORMAT_1(FORMAT_PIECE(cursor, a), __VA_ARGS__)
+#define FORMAT_3(cursor, a, ...) FORMAT_2(FORMAT_PIECE(cursor, a), __VA_ARGS__)
+#define FORMAT_4(cursor, a, ...) FORMAT_3(FORMAT_PIECE(cursor, a), __VA_ARGS__)
+#define FORMAT_5(cursor, a, ...) FORMAT_4(FORMAT_PIECE(cursor, a), __VA_ARGS__)
+#define FORMAT_6(cursor, a, ...) FORMAT_5(FORMAT_PIECE(cursor, a), __VA_ARGS__)
+#define FORMAT_7(cursor, a, ...) FORMAT_6(FORMAT_PIECE(cursor, a), __VA_ARGS__)
+#define FORMAT_8(cursor, a, ...) FORMAT_7(FORMAT_PIECE(cursor, a), __VA_ARGS__)
+#define FORMAT_9(cursor, a, ...) FORMAT_8(FORMAT_PIECE(cursor, a), __VA_ARGS__)
+#define FORMAT_10(cursor, a, ...) FORMAT_9(FORMAT_PIECE(cursor, a), __VA_ARGS__)
+#define FORMAT_CHOOSE(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, NAME, ...) NAME
+
+#define FORMAT(buffer, ...)                                                                         \
+        FORMAT_CHOOSE(__VA_ARGS__, FORMAT_10, FORMAT_9, FORMAT_8, FORMAT_7, FORMAT_6, FORMAT_5,     \
+                      FORMAT_4, FORMAT_3, FORMAT_2, FORMAT_1, )(buffer, __VA_ARGS__)
+
+#endif //__cplusplus
+
+#endif //COMBOLOCK_FORMAT_H
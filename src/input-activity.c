@@ -0,0 +1,47 @@
+/**************************************************************************/
+/**
+ *
+ * @file input-activity.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief input-activity.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include "input-activity.h"
+
+/*
+ * An increment from one ISR can be lost to another ISR's increment, but the
+ * count still moves, which is all that the consumers look for.
+ */
+static uint32_t volatile isr_changes = 0;
+static uint32_t control_changes = 0;
+static uint8_t controls_seen = 0;
+
+void note_input_activity(void) {
+    isr_changes++;
+}
+
+static uint8_t read_controls(void) {
+    return (uint8_t) ((cowpi_left_button_is_pressed() ? 0x1 : 0)
+                      | (cowpi_right_button_is_pressed() ? 0x2 : 0)
+                      | (cowpi_left_switch_is_in_right_position() ? 0x4 : 0)
+                      | (cowpi_right_switch_is_in_right_position() ? 0x8 : 0));
+}
+
+uint32_t count_input_changes(void) {
+    uint8_t controls = read_controls();
+    if (controls != controls_seen) {
+        controls_seen = controls;
+        control_changes++;
+    }
+    return isr_changes + control_changes;
+}
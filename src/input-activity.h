@@ -0,0 +1,50 @@
+/**************************************************************************/
+/**
+ *
+ * @file input-activity.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Notices whether anyone is using the lock, for the parts of the
+ *      firmware that save power while no one is.
+ *
+ * The encoder and the keypad catch their changes in ISRs, which call
+ * <code>note_input_activity()</code>. The buttons and switches are polled, so
+ * <code>count_input_changes()</code> reads them itself. Each consumer keeps the
+ * last count it saw; a different count means that an input has changed since.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_INPUT_ACTIVITY_H
+#define COMBOLOCK_INPUT_ACTIVITY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Records that an input has changed. It is safe to call from an ISR.
+ */
+void note_input_activity(void);
+
+/**
+ * Reads the buttons and switches, and counts input changes.
+ *
+ * @return A count that differs from the previous call's whenever an input has
+ *      changed in between
+ */
+uint32_t count_input_changes(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_INPUT_ACTIVITY_H
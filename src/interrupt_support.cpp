@@ -3,6 +3,10 @@
 
 #ifdef __AVR__
 
+#if ISR_PROFILING
+#error "ISR profiling is implemented for MBED only"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -15,6 +19,22 @@ void register_pin_ISR(uint32_t interrupt_mask, void (*isr)(void)) {
     cowpi_register_pin_ISR(interrupt_mask, isr);
 }
 
+void register_pin_ISR_with_priority(uint32_t interrupt_mask, void (*isr)(void), isr_priority_t priority) {
+    // the vector table fixes AVR priorities
+    register_pin_ISR(interrupt_mask, isr);
+}
+
+critical_section_t begin_critical_section(isr_priority_t ceiling) {
+    // AVR ISRs do not preempt each other, so there is nothing more urgent to leave running
+    critical_section_t section = {.masked_lines = 0, .interrupt_status = SREG, .blocks_every_interrupt = true};
+    cli();
+    return section;
+}
+
+void end_critical_section(critical_section_t section) {
+    SREG = (uint8_t) section.interrupt_status;
+}
+
 //#define NUMBER_OF_PRESCALERS (7)
 static unsigned int constexpr NUMBER_OF_PRESCALERS = 7;
 
@@ -130,44 +150,62 @@ float configure_timer(unsigned int timer_number, float desired_period_us) {
             }
         }
     }
+    if (best_error == INFINITY) {
+        // no prescaler reaches the desired period
+        return INFINITY;
+    }
     // Configure the timer
     uint8_t *mode_bits;
     uint32_t compare_A;
+    uint8_t number_of_isr_slots;
     if (timer->number_of_counter_values - best_count == 1) {    // the comparison value is the maximum possible comparison value
         mode_bits = timer->normal_mode_bits;
         compare_A = 2 * best_count / 3;
-        timer->number_of_isr_slots = 3;
+        number_of_isr_slots = 3;
     } else {
         mode_bits = timer->ctc_mode_bits;
         compare_A = best_count;
-        timer->number_of_isr_slots = 2;
+        number_of_isr_slots = 2;
     }
     uint32_t compare_B = compare_A / 2;
+    apply_timer_configuration(timer_number,
+                              mode_bits[0] | timer->clock_select_bits[0][best_index],
+                              mode_bits[1] | timer->clock_select_bits[1][best_index],
+                              compare_A, compare_B, number_of_isr_slots);
+    // printf("TCCR2 = %#04x,%02x\n", TCCR2B, TCCR2A);
+    // printf("OCR2A = %#04x\n", OCR2A);
+    return best_period;
+}
+
+void apply_timer_configuration(unsigned int timer_number, uint8_t control_a, uint8_t control_b,
+                               uint16_t compare_a, uint16_t compare_b, uint8_t number_of_isr_slots) {
+    struct timer_data *timer = timers + timer_number;
+    timer->interrupt_service_routines[0] = do_nothing;
+    timer->interrupt_service_routines[1] = do_nothing;
+    timer->interrupt_service_routines[2] = do_nothing;
+    timer->number_of_isr_slots = number_of_isr_slots;
     switch(timer_number) {
         case 1:
-            TCCR1A = mode_bits[0] | timer->clock_select_bits[0][best_index];
-            TCCR1B = mode_bits[1] | timer->clock_select_bits[1][best_index];
+            TCCR1A = control_a;
+            TCCR1B = control_b;
             TCCR1C = 0;
             TCNT1 = 0;
-            OCR1A = compare_A;
-            OCR1B = compare_B;
+            OCR1A = compare_a;
+            OCR1B = compare_b;
             TIMSK1 = 0;
             break;
         case 2:
-            TCCR2A = mode_bits[0] | timer->clock_select_bits[0][best_index];
-            TCCR2B = mode_bits[1] | timer->clock_select_bits[1][best_index];
+            TCCR2A = control_a;
+            TCCR2B = control_b;
             TCNT2 = 0;
-            OCR2A = compare_A;
-            OCR2B = compare_B;
+            OCR2A = compare_a;
+            OCR2B = compare_b;
             TIMSK2 = 0;
             break;
         default:
-            // unreachable
-            return INFINITY;
+            // for now, we'll prohibit TIMER0 and assume only TIMER1 & TIMER2 exist
+            return;
     }
-    // printf("TCCR2 = %#04x,%02x\n", TCCR2B, TCCR2A);
-    // printf("OCR2A = %#04x\n", OCR2A);
-    return best_period;
 }
 
 bool register_timer_ISR(unsigned int timer_number, unsigned int isr_slot, void (*isr)(void)) {
@@ -224,11 +262,224 @@ void reset_timer(unsigned int timer_number) {
 #ifdef __MBED__
 #include <InterruptIn.h>
 #include <Ticker.h>
+#include <hardware/irq.h>
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+#include "memory-map.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef struct {
+    uint32_t control_and_status;
+    uint32_t reload_value;
+    uint32_t current_value;
+    uint32_t calibration;
+} systick_t;
+
+static volatile systick_t *systick = (systick_t *) (SYSTICK_BASE_ADDRESS);
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *) (TIMER_BASE_ADDRESS);
+
+#if ISR_PROFILING
+
+struct isr_profile {
+    void (*isr)(void);
+    uint32_t period_us;
+    uint32_t expected_us;       // timers: when the next call is due; pins: when the previous call began
+    bool has_run;
+    struct isr_timing arrival_us;
+    struct isr_timing execution_cycles;
+};
+
+static struct isr_profile pin_profiles[32];
+static struct isr_profile timer_profiles[MAXIMUM_NUMBER_OF_TIMERS];
+static struct isr_profile flash_safe_profiles[MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS];
+
+static void start_cycle_counter(void) {
+    // the RTOS may already run SysTick for its tick; if not, let it count freely
+    if (!(systick->control_and_status & 0x1)) {
+        systick->reload_value = 0xFFFFFF;
+        systick->current_value = 0;
+        systick->control_and_status = 0x5;      // processor clock, enabled, no interrupt
+    }
+}
+
+// in RAM, as the flash-safe timers' dispatcher calls it during a flash stall
+static uint32_t __not_in_flash_func(cycles_since)(uint32_t start_ticks) {
+    // SysTick counts down and wraps at its reload value; avoid a division in the ISR path
+    int32_t elapsed = (int32_t) (start_ticks - systick->current_value);
+    if (elapsed < 0) {
+        elapsed += (systick->reload_value & 0xFFFFFF) + 1;
+    }
+    return (uint32_t) elapsed;
+}
+
+// in RAM, like cycles_since(), and so counting the bits itself rather than calling libgcc's __clzsi2 in flash
+static void __not_in_flash_func(record_timing)(struct isr_timing *timing, uint32_t value) {
+    unsigned int bucket = 0;
+    while (value >> bucket && bucket < ISR_PROFILE_BUCKETS - 1) {
+        bucket++;
+    }
+    timing->histogram[bucket]++;
+    if (timing->count == 0 || value < timing->minimum) {
+        timing->minimum = value;
+    }
+    if (value > timing->maximum) {
+        timing->maximum = value;
+    }
+    timing->count++;
+}
+
+static void run_profiled_pin_isr(struct isr_profile *profile) {
+    uint32_t entry_us = timer->raw_lower_word;
+    uint32_t entry_ticks = systick->current_value;
+    profile->isr();
+    record_timing(&profile->execution_cycles, cycles_since(entry_ticks));
+    if (profile->has_run) {
+        record_timing(&profile->arrival_us, entry_us - profile->expected_us);
+    }
+    profile->expected_us = entry_us;
+    profile->has_run = true;
+}
+
+static void run_profiled_timer_isr(struct isr_profile *profile) {
+    uint32_t entry_us = timer->raw_lower_word;
+    uint32_t entry_ticks = systick->current_value;
+    profile->isr();
+    record_timing(&profile->execution_cycles, cycles_since(entry_ticks));
+    // mbed's Ticker schedules each call one period after the previous call's scheduled time, not its actual time
+    int32_t lateness = (int32_t) (entry_us - profile->expected_us);
+    record_timing(&profile->arrival_us, (lateness > 0) ? lateness : 0);
+    profile->expected_us += profile->period_us;
+    profile->has_run = true;
+}
+
+static void append_reports(char source, struct isr_profile const profiles[], unsigned int number_of_profiles,
+                           struct isr_profile_report reports[], unsigned int capacity, unsigned int *count) {
+    for (unsigned int i = 0; i < number_of_profiles && *count < capacity; i++) {
+        if (profiles[i].has_run) {
+            reports[*count].source = source;
+            reports[*count].number = i;
+            reports[*count].arrival_us = profiles[i].arrival_us;
+            reports[*count].execution_cycles = profiles[i].execution_cycles;
+            (*count)++;
+        }
+    }
+}
+
+unsigned int get_isr_profiles(struct isr_profile_report reports[], unsigned int capacity) {
+    unsigned int count = 0;
+    uint32_t interrupt_status = save_and_disable_interrupts();
+    append_reports('P', pin_profiles, 32, reports, capacity, &count);
+    append_reports('T', timer_profiles, MAXIMUM_NUMBER_OF_TIMERS, reports, capacity, &count);
+    append_reports('F', flash_safe_profiles, MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS, reports, capacity, &count);
+    restore_interrupts(interrupt_status);
+    return count;
+}
+
+static void clear_profile(struct isr_profile *profile) {
+    memset(&profile->arrival_us, 0, sizeof(profile->arrival_us));
+    memset(&profile->execution_cycles, 0, sizeof(profile->execution_cycles));
+    profile->has_run = false;
+}
+
+void clear_isr_profiles(void) {
+    uint32_t interrupt_status = save_and_disable_interrupts();
+    for (struct isr_profile &profile : pin_profiles) {
+        clear_profile(&profile);
+    }
+    for (struct isr_profile &profile : timer_profiles) {
+        // a timer keeps its schedule; only its statistics restart
+        clear_profile(&profile);
+    }
+    for (struct isr_profile &profile : flash_safe_profiles) {
+        clear_profile(&profile);
+    }
+    restore_interrupts(interrupt_status);
+}
+
+#endif //ISR_PROFILING
+
+typedef struct {
+    uint32_t set_enable;
+    uint32_t reserved0[31];
+    uint32_t clear_enable;
+    uint32_t reserved1[31];
+    uint32_t set_pending;
+    uint32_t reserved2[31];
+    uint32_t clear_pending;
+    uint32_t reserved3[95];
+    uint32_t priority[8];           // four lines per word; the top two bits of each byte are the priority
+} nvic_t;
+
+static volatile nvic_t *nvic = (nvic_t *) (NVIC_BASE_ADDRESS);
+// the alarms' targets, and the register that disarms them; writing a target arms its alarm
+static volatile uint32_t *alarm_targets = (uint32_t *) (TIMER_BASE_ADDRESS + 0x10);
+static volatile uint32_t *alarms_armed = (uint32_t *) (TIMER_BASE_ADDRESS + 0x20);
+// the timer's interrupt registers lie past the end of cowpi_timer_t; alarm n raises interrupt line n
+static volatile uint32_t *alarm_interrupt_raw = (uint32_t *) (TIMER_BASE_ADDRESS + 0x34);
+static volatile uint32_t *alarm_interrupt_enable = (uint32_t *) (TIMER_BASE_ADDRESS + 0x38);
+static volatile uint32_t *alarm_interrupt_status = (uint32_t *) (TIMER_BASE_ADDRESS + 0x40);
+// the atomic set alias, so that enabling an alarm cannot race mbed's ticker enabling its own
+static volatile uint32_t *alarm_interrupt_enable_set = (uint32_t *) (TIMER_BASE_ADDRESS + 0x2000 + 0x38);
+// each GPIO has four bits in IO_BANK0's INTR registers; the upper two are its latched edges
+static volatile uint32_t *pin_interrupt_raw = (uint32_t *) (IO_BANK0_BASE_ADDRESS + 0xF0);
+static unsigned int constexpr GPIO_INTERRUPT_LINE = 13;     // IO_IRQ_BANK0
+static uint32_t constexpr ALARM_INTERRUPT_LINES = 0xF;
+
+static isr_priority_t pin_priorities[32];
+static isr_priority_t timer_priorities[MAXIMUM_NUMBER_OF_TIMERS];
+// for each ceiling, the lines that a critical section with that ceiling blocks
+static uint32_t lines_at_or_below[NUMBER_OF_ISR_PRIORITIES];
+// the alarms' lines that dispatch flash-safe timers; a flash stall leaves only these enabled
+static uint32_t flash_safe_lines = 0;
+
+static void set_line_priority(unsigned int line, isr_priority_t priority) {
+    // ARMv6-M allows only word accesses to the priority registers
+    uint32_t shift = 8 * (line % 4);
+    uint32_t interrupt_status = save_and_disable_interrupts();
+    nvic->priority[line / 4] = (nvic->priority[line / 4] & ~(0xFFu << shift)) | ((uint32_t) priority << (shift + 6));
+    restore_interrupts(interrupt_status);
+}
+
+static void find_lines_at_or_below(void) {
+    uint32_t lines[NUMBER_OF_ISR_PRIORITIES] = {0};
+    for (unsigned int line = 0; line < 32; line++) {
+        unsigned int priority = (nvic->priority[line / 4] >> (8 * (line % 4) + 6)) & 0x3;
+        for (unsigned int ceiling = 0; ceiling <= priority; ceiling++) {
+            lines[ceiling] |= 1u << line;
+        }
+    }
+    uint32_t interrupt_status = save_and_disable_interrupts();
+    memcpy(lines_at_or_below, lines, sizeof(lines));
+    restore_interrupts(interrupt_status);
+}
+
+critical_section_t begin_critical_section(isr_priority_t ceiling) {
+    critical_section_t section = {.masked_lines = 0, .interrupt_status = 0, .blocks_every_interrupt = false};
+    if (ceiling == ISR_PRIORITY_CRITICAL) {
+        section.interrupt_status = save_and_disable_interrupts();
+        section.blocks_every_interrupt = true;
+    } else {
+        // a line that is already disabled, by an enclosing section or by its driver, is not ours to re-enable
+        section.masked_lines = nvic->set_enable & lines_at_or_below[ceiling];
+        nvic->clear_enable = section.masked_lines;
+        // make sure that the lines are disabled before the protected code runs
+        __asm__ volatile ("dsb\n\tisb" : : : "memory");
+    }
+    return section;
+}
+
+void end_critical_section(critical_section_t section) {
+    if (section.blocks_every_interrupt) {
+        restore_interrupts(section.interrupt_status);
+    } else {
+        __asm__ volatile ("" : : : "memory");
+        nvic->set_enable = section.masked_lines;
+    }
+}
+
 static mbed::InterruptIn *inputs[32] = {
         nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
         nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
@@ -236,7 +487,22 @@ static mbed::InterruptIn *inputs[32] = {
         nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
 };
 
+static void apply_pin_priorities(void) {
+    isr_priority_t priority = ISR_PRIORITY_LOW;
+    for (unsigned int i = 0; i < 32; i++) {
+        if (inputs[i] != nullptr && pin_priorities[i] < priority) {
+            priority = pin_priorities[i];
+        }
+    }
+    set_line_priority(GPIO_INTERRUPT_LINE, priority);
+    find_lines_at_or_below();
+}
+
 void register_pin_ISR(uint32_t interrupt_mask, void (*isr)(void)) {
+    register_pin_ISR_with_priority(interrupt_mask, isr, ISR_PRIORITY_NORMAL);
+}
+
+void register_pin_ISR_with_priority(uint32_t interrupt_mask, void (*isr)(void), isr_priority_t priority) {
     int8_t i = 0;
     do {
         if (interrupt_mask & (1L << i)) {
@@ -244,11 +510,21 @@ void register_pin_ISR(uint32_t interrupt_mask, void (*isr)(void)) {
                 inputs[i] = new mbed::InterruptIn((PinName)i, PullUp);
             }
             inputs[i]->disable_irq();   // disable interrupts while we're making changes
-            inputs[i]->rise(isr);
-            inputs[i]->fall(isr);
+            pin_priorities[i] = priority;
+#if ISR_PROFILING
+            start_cycle_counter();
+            clear_profile(&pin_profiles[i]);
+            pin_profiles[i].isr = isr;
+            mbed::Callback<void()> handler = mbed::callback(run_profiled_pin_isr, &pin_profiles[i]);
+#else
+            void (*handler)(void) = isr;
+#endif
+            inputs[i]->rise(handler);
+            inputs[i]->fall(handler);
             inputs[i]->enable_irq();   // re-enable interrupts
         }
     } while (++i < 32);
+    apply_pin_priorities();
 }
 
 //static mbed::Ticker *tickers[MAXIMUM_NUMBER_OF_TICKERS] = {
@@ -274,6 +550,20 @@ struct timer_data {
 
 static std::chrono::microseconds constexpr no_time = std::chrono::microseconds(0);
 
+static void attach_timer(struct timer_data *timer_data, unsigned int timer_number) {
+#if ISR_PROFILING
+    struct isr_profile *profile = &timer_profiles[timer_number];
+    start_cycle_counter();
+    clear_profile(profile);
+    profile->isr = timer_data->interrupt_service_routine;
+    profile->period_us = (uint32_t) timer_data->period.count();
+    profile->expected_us = timer->raw_lower_word + profile->period_us;
+    timer_data->ticker->attach(mbed::callback(run_profiled_timer_isr, profile), timer_data->period);
+#else
+    timer_data->ticker->attach(timer_data->interrupt_service_routine, timer_data->period);
+#endif
+}
+
 static struct timer_data timers[MAXIMUM_NUMBER_OF_TIMERS] = {
         {.ticker = nullptr, .period = no_time, .interrupt_service_routine = nullptr,},
         {.ticker = nullptr, .period = no_time, .interrupt_service_routine = nullptr,},
@@ -285,7 +575,29 @@ static struct timer_data timers[MAXIMUM_NUMBER_OF_TIMERS] = {
         {.ticker = nullptr, .period = no_time, .interrupt_service_routine = nullptr,}
 };
 
+static void apply_timer_priorities(void) {
+    isr_priority_t priority = ISR_PRIORITY_LOW;
+    for (unsigned int i = 0; i < MAXIMUM_NUMBER_OF_TIMERS; i++) {
+        if (timers[i].ticker != nullptr && timer_priorities[i] < priority) {
+            priority = timer_priorities[i];
+        }
+    }
+    // the ticker has claimed its alarm and enabled the alarm's interrupt by the time a Ticker is attached
+    uint32_t alarm_lines = *alarm_interrupt_enable & ALARM_INTERRUPT_LINES & ~flash_safe_lines;
+    for (unsigned int line = 0; line < 32; line++) {
+        if (alarm_lines & (1u << line)) {
+            set_line_priority(line, priority);
+        }
+    }
+    find_lines_at_or_below();
+}
+
 bool register_periodic_timer_ISR(unsigned int timer_number, uint32_t period_us, void (*isr)(void)) {
+    return register_periodic_timer_ISR_with_priority(timer_number, period_us, isr, ISR_PRIORITY_NORMAL);
+}
+
+bool register_periodic_timer_ISR_with_priority(unsigned int timer_number, uint32_t period_us, void (*isr)(void),
+                                               isr_priority_t priority) {
     if (timer_number >= MAXIMUM_NUMBER_OF_TIMERS) {
         return false;
     }
@@ -294,7 +606,9 @@ bool register_periodic_timer_ISR(unsigned int timer_number, uint32_t period_us,
     }
     timers[timer_number].period = std::chrono::microseconds(period_us);
     timers[timer_number].interrupt_service_routine = isr;
-    timers[timer_number].ticker->attach(timers[timer_number].interrupt_service_routine, timers[timer_number].period);
+    timer_priorities[timer_number] = priority;
+    attach_timer(&timers[timer_number], timer_number);
+    apply_timer_priorities();
     return true;
 }
 
@@ -306,7 +620,134 @@ void reset_periodic_timer(unsigned int timer_number) {
         return;
     }
     timers[timer_number].ticker->detach();
-    timers[timer_number].ticker->attach(timers[timer_number].interrupt_service_routine, timers[timer_number].period);
+    attach_timer(&timers[timer_number], timer_number);
+}
+
+struct flash_safe_timer_data {
+    int alarm;                      // the hardware alarm that it has claimed, or -1
+    uint32_t period_us;
+    uint32_t next_due_us;
+    bool is_running;
+    void (*interrupt_service_routine)(void);
+};
+
+static struct flash_safe_timer_data flash_safe_timers[MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS] = {
+        {.alarm = -1, .period_us = 0, .next_due_us = 0, .is_running = false, .interrupt_service_routine = nullptr,},
+        {.alarm = -1, .period_us = 0, .next_due_us = 0, .is_running = false, .interrupt_service_routine = nullptr,}
+};
+
+static void __not_in_flash_func(handle_flash_safe_alarm)(void) {
+    for (unsigned int i = 0; i < MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS; i++) {
+        struct flash_safe_timer_data *timer_data = &flash_safe_timers[i];
+        if (timer_data->alarm < 0 || !(*alarm_interrupt_status & (1u << timer_data->alarm))) {
+            continue;
+        }
+        *alarm_interrupt_raw = 1u << timer_data->alarm;
+        if (!timer_data->is_running) {
+            continue;
+        }
+#if ISR_PROFILING
+        // unlike mbed's Ticker, this dispatcher knows each tick's due time
+        int32_t lateness = (int32_t) (timer->raw_lower_word - timer_data->next_due_us);
+#endif
+        // an alarm matches only the exact time, so a tick that is already late is skipped rather than lost for good
+        timer_data->next_due_us += timer_data->period_us;
+        while ((int32_t) (timer_data->next_due_us - timer->raw_lower_word) <= 0) {
+            timer_data->next_due_us += timer_data->period_us;
+        }
+        alarm_targets[timer_data->alarm] = timer_data->next_due_us;
+#if ISR_PROFILING
+        struct isr_profile *profile = &flash_safe_profiles[i];
+        uint32_t entry_ticks = systick->current_value;
+        timer_data->interrupt_service_routine();
+        record_timing(&profile->execution_cycles, cycles_since(entry_ticks));
+        record_timing(&profile->arrival_us, (lateness > 0) ? (uint32_t) lateness : 0);
+        profile->has_run = true;
+#else
+        timer_data->interrupt_service_routine();
+#endif
+    }
+}
+
+bool register_flash_safe_timer_ISR(unsigned int timer_number, uint32_t period_us, void (*isr)(void)) {
+    if (timer_number >= MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS || period_us == 0) {
+        return false;
+    }
+    struct flash_safe_timer_data *timer_data = &flash_safe_timers[timer_number];
+    set_flash_safe_timer_running(timer_number, false);
+    if (timer_data->alarm < 0) {
+        int alarm = hardware_alarm_claim_unused(false);
+        if (alarm < 0) {
+            return false;
+        }
+        timer_data->alarm = alarm;
+        // the SDK's vector table is in RAM, so the handler is entered without touching flash
+        irq_set_exclusive_handler((unsigned int) alarm, handle_flash_safe_alarm);
+        set_line_priority((unsigned int) alarm, ISR_PRIORITY_CRITICAL);
+        flash_safe_lines |= 1u << alarm;
+        find_lines_at_or_below();
+        *alarm_interrupt_enable_set = 1u << alarm;
+        irq_set_enabled((unsigned int) alarm, true);
+    }
+    timer_data->period_us = period_us;
+    timer_data->interrupt_service_routine = isr;
+#if ISR_PROFILING
+    start_cycle_counter();
+    clear_profile(&flash_safe_profiles[timer_number]);
+#endif
+    set_flash_safe_timer_running(timer_number, true);
+    return true;
+}
+
+void set_flash_safe_timer_running(unsigned int timer_number, bool is_running) {
+    if (timer_number >= MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS || flash_safe_timers[timer_number].alarm < 0) {
+        return;
+    }
+    struct flash_safe_timer_data *timer_data = &flash_safe_timers[timer_number];
+    uint32_t interrupt_status = save_and_disable_interrupts();
+    timer_data->is_running = is_running;
+    if (is_running) {
+        timer_data->next_due_us = timer->raw_lower_word + timer_data->period_us;
+        alarm_targets[timer_data->alarm] = timer_data->next_due_us;
+    } else {
+        *alarms_armed = 1u << timer_data->alarm;
+        *alarm_interrupt_raw = 1u << timer_data->alarm;
+    }
+    restore_interrupts(interrupt_status);
+}
+
+flash_stall_t begin_flash_stall(void) {
+    flash_stall_t stall;
+    uint32_t interrupt_status = save_and_disable_interrupts();
+    // SysTick is an exception, not an NVIC line, and the RTOS's handler for it is in flash
+    stall.has_paused_systick = (systick->control_and_status & 0x2) != 0;
+    if (stall.has_paused_systick) {
+        systick->control_and_status &= ~0x2u;
+    }
+    // a line that is already disabled is not ours to re-enable
+    stall.section.masked_lines = nvic->set_enable & ~flash_safe_lines;
+    stall.section.interrupt_status = 0;
+    stall.section.blocks_every_interrupt = false;
+    nvic->clear_enable = stall.section.masked_lines;
+    __asm__ volatile ("dsb\n\tisb" : : : "memory");
+    restore_interrupts(interrupt_status);
+    return stall;
+}
+
+void end_flash_stall(flash_stall_t stall) {
+    end_critical_section(stall.section);
+    if (stall.has_paused_systick) {
+        systick->control_and_status |= 0x2u;
+    }
+}
+
+void discard_pending_pin_interrupts(uint32_t interrupt_mask) {
+    for (unsigned int pin = 0; pin < 32; pin++) {
+        if (interrupt_mask & (1u << pin)) {
+            // the edge bits are write-one-to-clear; the level bits are read-only
+            pin_interrupt_raw[pin / 8] = 0xCu << (4 * (pin % 8));
+        }
+    }
 }
 
 #ifdef __cplusplus
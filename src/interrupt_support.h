@@ -5,6 +5,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /**
@@ -56,6 +57,80 @@ void register_pin_ISR(uint32_t interrupt_mask, void (*isr)(void));
  */
 void reset_periodic_timer(unsigned int timer_number);
 
+/*
+ * Interrupt priorities. A more urgent ISR preempts a less urgent one that is
+ * running and is chosen first when both are pending. Every ISR registered
+ * without a priority runs at ISR_PRIORITY_NORMAL, as does every interrupt that
+ * this file does not manage (USB, the I2C and UART drivers, and so on).
+ *
+ * On MBED, priorities belong to interrupt lines, not to ISRs: all pin ISRs
+ * share the GPIO line, and all periodic timer ISRs share the alarm that drives
+ * mbed's microsecond ticker. A line runs at the most urgent priority of the
+ * ISRs registered on it.
+ *
+ * On AVR, the order of the interrupt vectors fixes the priorities and no ISR
+ * preempts another, so the priority is accepted and ignored.
+ */
+typedef enum {
+    ISR_PRIORITY_CRITICAL,
+    ISR_PRIORITY_HIGH,
+    ISR_PRIORITY_NORMAL,
+    ISR_PRIORITY_LOW,
+    NUMBER_OF_ISR_PRIORITIES
+} isr_priority_t;
+
+/**
+ * @brief Registers a function to service pin-based interrupts, as
+ * <code>register_pin_ISR()</code> does, at the given priority.
+ *
+ * @param interrupt_mask A bit vector specifying which pins will be serviced by
+ *      the registered ISR
+ * @param isr The function that will service interrupts triggered by changes on
+ *      the specified pins
+ * @param priority How urgently the ISR must run
+ */
+void register_pin_ISR_with_priority(uint32_t interrupt_mask, void (*isr)(void), isr_priority_t priority);
+
+/**
+ * What <code>end_critical_section()</code> needs to undo a
+ * <code>begin_critical_section()</code>.
+ */
+typedef struct {
+    uint32_t masked_lines;          // the interrupt lines that this critical section disabled
+    uint32_t interrupt_status;      // the global interrupt state, when the section disabled every interrupt
+    bool blocks_every_interrupt;
+} critical_section_t;
+
+/**
+ * @brief Blocks the ISRs that could interfere with a short piece of code,
+ * while ISRs more urgent than those keep running.
+ *
+ * Blocks every interrupt line whose priority is <code>ceiling</code> or less
+ * urgent. A ceiling of <code>ISR_PRIORITY_CRITICAL</code> blocks every
+ * interrupt. For example, code that shares data with the quadrature ISR
+ * (registered at <code>ISR_PRIORITY_NORMAL</code>) may use a ceiling of
+ * <code>ISR_PRIORITY_NORMAL</code>, and the servo's timer ISR (registered at
+ * <code>ISR_PRIORITY_CRITICAL</code>) will still run on time.
+ *
+ * Critical sections may nest, and may be used in ISRs. An interrupt that
+ * arrives during the section is serviced when the section ends.
+ *
+ * On AVR, every critical section blocks every interrupt.
+ *
+ * @param ceiling The most urgent priority to block
+ * @return What <code>end_critical_section()</code> needs to end the section
+ */
+critical_section_t begin_critical_section(isr_priority_t ceiling);
+
+/**
+ * @brief Unblocks the interrupts that the matching
+ * <code>begin_critical_section()</code> blocked.
+ *
+ * @param section The value returned by the matching
+ *      <code>begin_critical_section()</code>
+ */
+void end_critical_section(critical_section_t section);
+
 #ifdef __AVR__
 
 /**
@@ -106,9 +181,88 @@ float configure_timer(unsigned int timer_number, float desired_period_us);
  */
 bool register_timer_ISR(unsigned int timer_number, unsigned int isr_slot, void (*isr)(void));
 
+/**
+ * @brief Writes an AVR timer configuration that has already been chosen.
+ *
+ * This is the back end of <code>configure_timer()</code> and of the
+ * compile-time <code>configure_timer_at_compile_time()</code>; call one of
+ * those instead.
+ *
+ * Any ISRs that had previously been registered for the timer will be
+ * deregistered.
+ *
+ * @param timer_number The timer to be configured, 1 or 2
+ * @param control_a The value for TCCRnA
+ * @param control_b The value for TCCRnB
+ * @param compare_a The value for OCRnA
+ * @param compare_b The value for OCRnB
+ * @param number_of_isr_slots 3 in Normal mode, 2 in CTC mode
+ */
+void apply_timer_configuration(unsigned int timer_number, uint8_t control_a, uint8_t control_b,
+                               uint16_t compare_a, uint16_t compare_b, uint8_t number_of_isr_slots);
+
 #endif //__AVR__
 
-#ifdef __MBED__
+/*
+ * Profiling of registered ISRs, for finding what delays what. Off unless built
+ * with -D ISR_PROFILING=1; when off, ISRs are registered directly and the
+ * profiler costs nothing. When on, each pin and timer ISR is called through a
+ * wrapper that times it, which adds a few microseconds to each call; the
+ * flash-safe timers' dispatcher, which runs from RAM, times its ISRs itself.
+ *
+ * Implemented for MBED only.
+ */
+#ifndef ISR_PROFILING
+#define ISR_PROFILING (0)
+#endif
+
+#if ISR_PROFILING
+
+#define ISR_PROFILE_BUCKETS (16)
+
+/**
+ * Distribution of one measurement of one ISR. Histogram bucket 0 counts
+ * values of 0, and bucket <i>b</i> counts values from 2<sup><i>b</i>-1</sup>
+ * up to 2<sup><i>b</i></sup>, except that the last bucket also counts anything
+ * larger.
+ */
+struct isr_timing {
+    uint32_t count;
+    uint32_t minimum;
+    uint32_t maximum;
+    uint32_t histogram[ISR_PROFILE_BUCKETS];
+};
+
+struct isr_profile_report {
+    char source;                    // 'P' for a pin ISR, 'T' for a timer ISR, 'F' for a flash-safe timer ISR
+    uint8_t number;                 // the pin or timer number
+    /*
+     * For a timer ISR, how many microseconds after its scheduled time it was
+     * entered. A pin change carries no timestamp, so for a pin ISR, how many
+     * microseconds had passed since the previous entry for that pin.
+     */
+    struct isr_timing arrival_us;
+    struct isr_timing execution_cycles;
+};
+
+/**
+ * Copies the profiles of the ISRs that have run since they were registered or
+ * last cleared.
+ *
+ * @param reports Receives the profiles
+ * @param capacity The number of profiles that <code>reports</code> can hold
+ * @return The number of profiles copied
+ */
+unsigned int get_isr_profiles(struct isr_profile_report reports[], unsigned int capacity);
+
+/**
+ * Discards the profiles gathered so far.
+ */
+void clear_isr_profiles(void);
+
+#endif //ISR_PROFILING
+
+#if defined(__MBED__) || defined(COWPI_MOCK)
 
 //static unsigned int constexpr MAXIMUM_NUMBER_OF_TICKERS = 8;
 #define MAXIMUM_NUMBER_OF_TIMERS (8)     // gotta maintain portability with pre-C23 for now
@@ -131,10 +285,261 @@ bool register_timer_ISR(unsigned int timer_number, unsigned int isr_slot, void (
  */
 bool register_periodic_timer_ISR(unsigned int timer_number, uint32_t period_us, void (*isr)(void));
 
-#endif //__MBED__
+/**
+ * @brief Configures a timer interrupt, as
+ * <code>register_periodic_timer_ISR()</code> does, at the given priority.
+ *
+ * @param timer_number A unique handle for the virtual timer being configured
+ * @param period_us The specified interrupt period
+ * @param isr The function that will service the timer's interrupts
+ * @param priority How urgently the ISR must run
+ * @return <code>true</code> if the periodic interrupt was successfully
+ *      configured and the ISR was successfully registered; <code>false</code>
+ *      otherwise
+ */
+bool register_periodic_timer_ISR_with_priority(unsigned int timer_number, uint32_t period_us, void (*isr)(void),
+                                               isr_priority_t priority);
+
+/*
+ * Flash-safe ISRs. The RP2040 executes from flash, so while flash is erased or
+ * programmed, any code fetched from it stalls until the operation ends. A
+ * flash-safe timer ISR is dispatched by a handler that runs from RAM, straight
+ * from its own hardware alarm rather than through mbed's ticker, at
+ * ISR_PRIORITY_CRITICAL. It keeps running during a flash stall, provided that
+ * the ISR is itself defined with FLASH_SAFE_ISR() and calls nothing but inline
+ * functions, and that it has no switch statement (whose jump table would be in
+ * flash). Its data is in RAM already, unless it is const.
+ */
+#define MAXIMUM_NUMBER_OF_FLASH_SAFE_TIMERS (2)
+
+#ifdef __MBED__
+#include <pico/platform.h>
+#define FLASH_SAFE_ISR(name) __not_in_flash_func(name)
+#else
+#define FLASH_SAFE_ISR(name) name
+#endif
+
+/**
+ * @brief Claims a hardware alarm for a flash-safe timer ISR, and starts it.
+ *
+ * @param timer_number A unique handle for the flash-safe timer, distinct from
+ *      the handles of <code>register_periodic_timer_ISR()</code>
+ * @param period_us The specified interrupt period
+ * @param isr The function, defined with <code>FLASH_SAFE_ISR()</code>, that
+ *      will service the timer's interrupts
+ * @return <code>true</code> if a hardware alarm was available and the ISR was
+ *      registered; <code>false</code> otherwise
+ */
+bool register_flash_safe_timer_ISR(unsigned int timer_number, uint32_t period_us, void (*isr)(void));
+
+/**
+ * @brief Starts or stops a flash-safe timer. A timer that starts runs its ISR
+ * one period later.
+ *
+ * @param timer_number The handle it was registered with
+ * @param is_running Whether it should run
+ */
+void set_flash_safe_timer_running(unsigned int timer_number, bool is_running);
+
+/**
+ * What <code>end_flash_stall()</code> needs to undo a
+ * <code>begin_flash_stall()</code>.
+ */
+typedef struct {
+    critical_section_t section;
+    bool has_paused_systick;
+} flash_stall_t;
+
+/**
+ * @brief Blocks every interrupt except the flash-safe timers, so that flash
+ * can be erased or programmed.
+ *
+ * The RTOS's SysTick interrupt is blocked too, and so the RTOS's tick falls
+ * behind by the length of the stall; the microsecond timer does not.
+ *
+ * @return What <code>end_flash_stall()</code> needs to end the stall
+ */
+flash_stall_t begin_flash_stall(void);
+
+/**
+ * @brief Unblocks the interrupts that the matching
+ * <code>begin_flash_stall()</code> blocked.
+ *
+ * @param stall The value returned by the matching
+ *      <code>begin_flash_stall()</code>
+ */
+void end_flash_stall(flash_stall_t stall);
+
+/**
+ * @brief Forgets the pin changes that have been latched but not yet serviced,
+ * for an ISR that has already seen them some other way.
+ *
+ * @param interrupt_mask A bit vector specifying the pins
+ */
+void discard_pending_pin_interrupts(uint32_t interrupt_mask);
+
+#endif //__MBED__ || COWPI_MOCK
 
 #ifdef __cplusplus
 } // extern "C"
 #endif
 
+#ifdef __cplusplus
+
+/*
+ * The search that configure_timer() makes at run time, made at compile time
+ * instead. The arithmetic is in whole clock cycles, so no floating-point code
+ * is linked in. It is plain constexpr code, so any C++ compiler checks it, not
+ * only the AVR's.
+ */
+namespace avr_timer_solver {
+
+static uint32_t constexpr CYCLES_PER_US = 16;
+static unsigned int constexpr NUMBER_OF_PRESCALERS = 7;
+
+struct solution {
+    bool is_valid;
+    unsigned int prescaler_index;       // the clock-select bits are one more than this
+    uint32_t count;                     // timer ticks per period
+    uint32_t error_cycles;
+};
+
+constexpr uint32_t prescaler(unsigned int timer_number, unsigned int index) {
+    return (timer_number == 2)
+           ? ((index == 0) ? 1 : (index == 1) ? 8 : (index == 2) ? 32 : (index == 3) ? 64
+                                : (index == 4) ? 128 : (index == 5) ? 256 : (index == 6) ? 1024 : 0)
+           : ((index == 0) ? 1 : (index == 1) ? 8 : (index == 2) ? 64 : (index == 3) ? 256
+                                : (index == 4) ? 1024 : 0);
+}
+
+constexpr uint32_t number_of_counter_values(unsigned int timer_number) {
+    return (timer_number == 1) ? (1UL << 16) : (1UL << 8);
+}
+
+constexpr uint32_t difference(uint32_t a, uint32_t b) {
+    return (a > b) ? a - b : b - a;
+}
+
+constexpr solution candidate(unsigned int timer_number, uint32_t desired_cycles, unsigned int index,
+                             uint32_t count) {
+    return solution{
+            prescaler(timer_number, index) != 0 && count >= 1 && count <= number_of_counter_values(timer_number),
+            index, count, difference(count * prescaler(timer_number, index), desired_cycles)
+    };
+}
+
+// like configure_timer(), the first candidate wins a tie
+constexpr solution better(solution best, solution contender) {
+    return (contender.is_valid && (!best.is_valid || contender.error_cycles < best.error_cycles)) ? contender : best;
+}
+
+constexpr solution solve_from(unsigned int timer_number, uint32_t desired_cycles, unsigned int index,
+                              solution best) {
+    return (index >= NUMBER_OF_PRESCALERS || prescaler(timer_number, index) == 0)
+           ? best
+           : solve_from(timer_number, desired_cycles, index + 1, better(better(best,
+                   // the count just above the exact one, then the count just below
+                   candidate(timer_number, desired_cycles, index,
+                             (desired_cycles + prescaler(timer_number, index) - 1) / prescaler(timer_number, index))),
+                   candidate(timer_number, desired_cycles, index, desired_cycles / prescaler(timer_number, index))));
+}
+
+constexpr solution solve(unsigned int timer_number, uint32_t desired_cycles) {
+    return solve_from(timer_number, desired_cycles, 0, solution{false, 0, 0, 0});
+}
+
+} // namespace avr_timer_solver
+
+/**
+ * An AVR timer configuration chosen at compile time. The selection matches
+ * <code>configure_timer()</code>'s: the prescaler and count whose period is
+ * closest to the desired period, in Normal mode if the count fills the
+ * counter and in CTC mode otherwise.
+ *
+ * A period that no configuration reaches to within
+ * <code>TOLERANCE_PPM</code> parts per million is a compile-time error.
+ *
+ * @tparam TIMER_NUMBER The timer to be configured, 1 or 2
+ * @tparam DESIRED_PERIOD_US The preferred interrupt period
+ * @tparam TOLERANCE_PPM How far the actual period may be from the desired one
+ */
+template<unsigned int TIMER_NUMBER, uint32_t DESIRED_PERIOD_US, uint32_t TOLERANCE_PPM = 1000>
+struct avr_timer_configuration {
+    static_assert(TIMER_NUMBER == 1 || TIMER_NUMBER == 2, "only TIMER1 and TIMER2 may be configured");
+    static_assert(DESIRED_PERIOD_US <= 0xFFFFFFFFUL / avr_timer_solver::CYCLES_PER_US, "the period is far too long");
+
+    static uint32_t constexpr DESIRED_CYCLES = DESIRED_PERIOD_US * avr_timer_solver::CYCLES_PER_US;
+    static bool constexpr IS_VALID = avr_timer_solver::solve(TIMER_NUMBER, DESIRED_CYCLES).is_valid;
+    static unsigned int constexpr PRESCALER_INDEX =
+            avr_timer_solver::solve(TIMER_NUMBER, DESIRED_CYCLES).prescaler_index;
+    static uint32_t constexpr COUNT = avr_timer_solver::solve(TIMER_NUMBER, DESIRED_CYCLES).count;
+    static uint32_t constexpr ERROR_CYCLES = avr_timer_solver::solve(TIMER_NUMBER, DESIRED_CYCLES).error_cycles;
+
+    static_assert(IS_VALID, "no prescaler reaches the desired period");
+    static_assert((uint64_t) ERROR_CYCLES * 1000000 <= (uint64_t) TOLERANCE_PPM * DESIRED_CYCLES,
+                  "the closest period the timer can reach is outside the tolerance");
+
+    // the period that the timer will actually have, in clock cycles of 1/16 microsecond
+    static uint32_t constexpr ACTUAL_PERIOD_CYCLES = COUNT * avr_timer_solver::prescaler(TIMER_NUMBER, PRESCALER_INDEX);
+    static bool constexpr IS_NORMAL_MODE = (COUNT == avr_timer_solver::number_of_counter_values(TIMER_NUMBER));
+    static uint8_t constexpr NUMBER_OF_ISR_SLOTS = IS_NORMAL_MODE ? 3 : 2;
+
+    // CTC mode is WGM21 in TCCR2A for TIMER2, but WGM12 in TCCR1B for TIMER1
+    static uint8_t constexpr CONTROL_A = (TIMER_NUMBER == 2 && !IS_NORMAL_MODE) ? (1 << 1) : 0;
+    static uint8_t constexpr CONTROL_B =
+            ((TIMER_NUMBER == 1 && !IS_NORMAL_MODE) ? (1 << 3) : 0) | (uint8_t) (PRESCALER_INDEX + 1);
+    static uint16_t constexpr COMPARE_A = IS_NORMAL_MODE ? 2 * (COUNT - 1) / 3 : COUNT - 1;
+    static uint16_t constexpr COMPARE_B = COMPARE_A / 2;
+};
+
+// known solutions, checked by every C++ build
+static_assert(avr_timer_configuration<1, 100>::PRESCALER_INDEX == 0
+              && avr_timer_configuration<1, 100>::COUNT == 1600
+              && avr_timer_configuration<1, 100>::ERROR_CYCLES == 0
+              && avr_timer_configuration<1, 100>::CONTROL_B == ((1 << 3) | 1),
+              "TIMER1 reaches 100us with no prescaling, in CTC mode");
+static_assert(avr_timer_configuration<2, 100>::PRESCALER_INDEX == 1
+              && avr_timer_configuration<2, 100>::COUNT == 200
+              && avr_timer_configuration<2, 100>::COMPARE_A == 199
+              && avr_timer_configuration<2, 100>::CONTROL_A == (1 << 1),
+              "TIMER2 reaches 100us with a prescaler of 8, in CTC mode");
+static_assert(avr_timer_configuration<1, 1000>::PRESCALER_INDEX == 0
+              && avr_timer_configuration<1, 1000>::COUNT == 16000
+              && avr_timer_configuration<1, 1000>::ACTUAL_PERIOD_CYCLES == 16000,
+              "TIMER1 reaches 1ms with no prescaling");
+static_assert(avr_timer_configuration<2, 1000>::PRESCALER_INDEX == 3
+              && avr_timer_configuration<2, 1000>::COUNT == 250
+              && avr_timer_configuration<2, 1000>::ERROR_CYCLES == 0,
+              "TIMER2 reaches 1ms with a prescaler of 64");
+static_assert(avr_timer_configuration<2, 1024>::IS_NORMAL_MODE
+              && avr_timer_configuration<2, 1024>::NUMBER_OF_ISR_SLOTS == 3
+              && avr_timer_configuration<2, 1024>::CONTROL_B == 4,
+              "TIMER2 fills its counter at 1024us with a prescaler of 64, in Normal mode");
+static_assert(avr_timer_solver::solve(2, 256UL * 1024).is_valid && !avr_timer_solver::solve(2, 257UL * 1024).is_valid,
+              "TIMER2 counts at most 256 ticks of its largest prescaler");
+
+#ifdef __AVR__
+
+/**
+ * @brief Configures an AVR timer, as <code>configure_timer()</code> does, with
+ * the configuration chosen at compile time.
+ *
+ * @tparam TIMER_NUMBER The timer to be configured, 1 or 2
+ * @tparam DESIRED_PERIOD_US The preferred interrupt period
+ * @tparam TOLERANCE_PPM How far the actual period may be from the desired one
+ * @return The actual interrupt period, in clock cycles of 1/16 microsecond
+ */
+template<unsigned int TIMER_NUMBER, uint32_t DESIRED_PERIOD_US, uint32_t TOLERANCE_PPM = 1000>
+inline uint32_t configure_timer_at_compile_time() {
+    typedef avr_timer_configuration<TIMER_NUMBER, DESIRED_PERIOD_US, TOLERANCE_PPM> configuration;
+    apply_timer_configuration(TIMER_NUMBER, configuration::CONTROL_A, configuration::CONTROL_B,
+                              configuration::COMPARE_A, configuration::COMPARE_B,
+                              configuration::NUMBER_OF_ISR_SLOTS);
+    return configuration::ACTUAL_PERIOD_CYCLES;
+}
+
+#endif //__AVR__
+
+#endif //__cplusplus
+
 #endif //INTERRUPT_SUPPORT_H
@@ -0,0 +1,118 @@
+/**************************************************************************/
+/**
+ *
+ * @file keypad.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief keypad.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+// clang-format off
+#include <CowPi.h>
+#include "input-activity.h"
+#include "interrupt_support.h"
+#include "keypad.h"
+#include "memory-map.h"
+#include "telemetry.h"
+#include "trace.h"
+// clang-format on
+
+_Static_assert((KEY_EVENT_QUEUE_CAPACITY & (KEY_EVENT_QUEUE_CAPACITY - 1)) == 0,
+               "KEY_EVENT_QUEUE_CAPACITY must be a power of two");
+
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *) (TIMER_BASE_ADDRESS);
+
+/*
+ * The ISR is the only writer of next_to_write and the controller the only
+ * writer of next_to_read, so neither needs to block the other. Both count
+ * without wrapping at the capacity; their difference is the number of events
+ * queued.
+ */
+static key_event_t volatile queue[KEY_EVENT_QUEUE_CAPACITY];
+static uint8_t volatile next_to_write = 0;
+static uint8_t volatile next_to_read = 0;
+
+// the ISR's debouncing state
+static char believed_key = '\0';
+static char candidate_key = '\0';
+static uint32_t candidate_since_us = 0;
+static uint8_t candidate_scans = 0;
+
+static void scan_keypad();
+
+#ifdef PIO_UNIT_TESTING
+// lets the on-target benchmarks call the ISR directly
+void (*const keypad_isr)(void) = scan_keypad;
+#endif
+
+void initialize_keypad() {
+    next_to_read = next_to_write;
+    believed_key = '\0';
+    candidate_key = '\0';
+    candidate_scans = KEYPAD_DEBOUNCE_SCANS;
+    register_periodic_timer_ISR_with_priority(KEYPAD_TIMER, KEYPAD_SCAN_PERIOD_uS, scan_keypad, ISR_PRIORITY_LOW);
+}
+
+bool take_key_event(key_event_t *event) {
+    uint8_t position = next_to_read;
+    if (position == next_to_write) {
+        return false;
+    }
+    *event = queue[position & (KEY_EVENT_QUEUE_CAPACITY - 1)];
+    // advance only after the copy, so that the ISR cannot overwrite the event while it is being read
+    next_to_read = (uint8_t) (position + 1);
+    return true;
+}
+
+void discard_key_events() {
+    next_to_read = next_to_write;
+}
+
+static void queue_key_event(char key, key_action_t action, uint32_t timestamp_us) {
+    uint8_t position = next_to_write;
+    if ((uint8_t) (position - next_to_read) >= KEY_EVENT_QUEUE_CAPACITY) {
+        telemetry_count(TELEMETRY_DROPPED_KEY_EVENTS);
+        return;
+    }
+    key_event_t volatile *event = &queue[position & (KEY_EVENT_QUEUE_CAPACITY - 1)];
+    event->timestamp_us = timestamp_us;
+    event->key = key;
+    event->action = action;
+    // publish only after the event is complete
+    next_to_write = (uint8_t) (position + 1);
+    // traced as it is queued, so that the trace has every keypress whether or not anything is waiting for one
+    if (action == KEY_PRESSED) {
+        trace_record(TRACE_KEYPRESS, (uint8_t) key);
+    }
+}
+
+static void scan_keypad() {
+    telemetry_count(TELEMETRY_KEYPAD_INTERRUPTS);
+    char reading = cowpi_get_keypress();
+    if (reading != candidate_key) {
+        candidate_key = reading;
+        candidate_since_us = timer->raw_lower_word;
+        candidate_scans = 1;
+        // wake the display on the first edge, not after debouncing
+        note_input_activity();
+    } else if (candidate_scans < KEYPAD_DEBOUNCE_SCANS) {
+        candidate_scans++;
+    }
+    if (candidate_scans == KEYPAD_DEBOUNCE_SCANS && candidate_key != believed_key) {
+        if (believed_key != '\0') {
+            queue_key_event(believed_key, KEY_RELEASED, candidate_since_us);
+        }
+        if (candidate_key != '\0') {
+            queue_key_event(candidate_key, KEY_PRESSED, candidate_since_us);
+        }
+        believed_key = candidate_key;
+    }
+}
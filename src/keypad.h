@@ -0,0 +1,74 @@
+/**************************************************************************/
+/**
+ *
+ * @file keypad.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Keypad scanning in a periodic timer ISR, with debouncing and a queue
+ *      of timestamped key-down and key-up events.
+ *
+ * The ISR scans the matrix every <code>KEYPAD_SCAN_PERIOD_uS</code>. A reading
+ * must hold for <code>KEYPAD_DEBOUNCE_SCANS</code> consecutive scans before it
+ * is believed; a change of the believed key queues a key-up for the old key
+ * and a key-down for the new one, each stamped with the time that the new
+ * reading was first seen. The controller takes events from the queue whenever
+ * it gets around to it, so a slow pass of <code>loop()</code> delays
+ * keystrokes but does not lose them. Only a full queue drops events, and
+ * those are counted as <code>TELEMETRY_DROPPED_KEY_EVENTS</code>.
+ *
+ * On MBED, the scan runs from mbed's Ticker, at a lower priority than the
+ * servo's tick, which has a hardware alarm of its own; a scan therefore never
+ * delays a servo edge. A scan is one call to <code>cowpi_get_keypress()</code>.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_KEYPAD_H
+#define COMBOLOCK_KEYPAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define KEYPAD_TIMER (1)
+#define KEYPAD_SCAN_PERIOD_uS (1000)
+#define KEYPAD_DEBOUNCE_SCANS (5)
+#define KEY_EVENT_QUEUE_CAPACITY (16)  // must be a power of two
+
+typedef enum {
+    KEY_PRESSED,
+    KEY_RELEASED
+} key_action_t;
+
+typedef struct {
+    uint32_t timestamp_us;          // when the scan first saw the change, on the microsecond timer
+    char key;
+    key_action_t action;
+} key_event_t;
+
+/**
+ * Empties the event queue and starts scanning the keypad.
+ */
+void initialize_keypad();
+
+/**
+ * Takes the oldest event from the queue.
+ *
+ * @param event Receives the event, if there is one
+ * @return <code>true</code> if an event was taken; <code>false</code> if the
+ *      queue was empty
+ */
+bool take_key_event(key_event_t *event);
+
+/**
+ * Empties the event queue, such as when a flow that reads keys begins and
+ * should not see keys pressed before it.
+ */
+void discard_key_events();
+
+#endif //COMBOLOCK_KEYPAD_H
@@ -0,0 +1,95 @@
+/**************************************************************************/
+/**
+ *
+ * @file lock-bank.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief What the lock controller makes available beyond the starter
+ *      lock-controller.h: the modes of the locks in the bank, the events that
+ *      move a lock between modes, and hooks for the diagnostics and the tests.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_LOCK_BANK_H
+#define COMBOLOCK_LOCK_BANK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { LOCKED,
+               UNLOCKED,
+               ALARMED,
+               CHANGING,
+               NUMBER_OF_LOCK_MODES } lock_mode_t;
+
+// the events in the controller's transition table, as recorded in the trace's TRACE_TRANSITION entries
+typedef enum { NO_EVENT,
+               ATTEMPT_ACCEPTED,
+               ATTEMPT_REJECTED,
+               TOO_MANY_ATTEMPTS,
+               RELOCK_REQUESTED,
+               CHANGE_REQUESTED,
+               CHANGE_FINISHED,
+               NUMBER_OF_LOCK_EVENTS } lock_event_t;
+
+/**
+ * @return The mode of the lock that the console belongs to
+ */
+lock_mode_t get_lock_mode();
+
+/**
+ * Reports the mode of the most urgent lock in the bank: any alarmed lock,
+ * otherwise any lock being changed, otherwise any unlocked lock. The display's
+ * idle policy and the clock governor follow this mode rather than the
+ * console's, so that a lock that is not on the console still keeps the
+ * display on and the clock up.
+ *
+ * @return <code>LOCKED</code> only if every lock is locked
+ */
+lock_mode_t get_bank_mode();
+
+/**
+ * @return The longest that one call to <code>control_lock()</code> has taken,
+ *      in microseconds
+ */
+uint32_t get_worst_control_step_us();
+
+/**
+ * Forgets the checkpoint in retained RAM, so that the next
+ * <code>initialize_lock_controller()</code> is a cold start.
+ */
+void discard_lock_checkpoint();
+
+/**
+ * Sets one lock's combination, mode, and bad attempts in the checkpoint, so
+ * that the next <code>initialize_lock_controller()</code> resumes from them as
+ * it would after a warm reset. For tools that start the controller part-way
+ * through a recorded session; call it after the controller is initialized.
+ *
+ * @param lock The lock whose state is set
+ * @param combination The lock's combination, <code>COMBINATION_LENGTH</code>
+ *      numbers
+ * @param mode The lock's mode; a warm reset does not resume
+ *      <code>CHANGING</code>, so neither does this
+ * @param bad_tries The number of bad attempts made on the lock
+ * @return <code>true</code> if the state was set; <code>false</code> if it
+ *      is not a state that a warm reset could resume
+ */
+bool checkpoint_lock_state(uint8_t lock, uint8_t const *combination, lock_mode_t mode, uint8_t bad_tries);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_LOCK_BANK_H
@@ -0,0 +1,127 @@
+/**************************************************************************/
+/**
+ *
+ * @file lock-config.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Compile-time parameters for the combination lock: how many numbers
+ *      are in a combination, how many positions are on the dial, how many
+ *      times the dial must pass each number, and how many locks the board
+ *      drives.
+ *
+ * Each parameter may be overridden with a build flag, such as
+ * <code>-D DIAL_POSITIONS=40</code>. The defaults describe the original lock:
+ * three numbers on a 16-position dial, passing the first number three times,
+ * the second twice, and the third exactly once.
+ *
+ * A board may drive a bank of up to <code>MAXIMUM_NUMBER_OF_LOCKS</code>
+ * locks, each with its own encoder, servo, and combination; the buttons,
+ * switches, keypad, LEDs, and display are shared. A bank must say where each
+ * lock is connected, as in
+ * <code>-D NUMBER_OF_LOCKS=2 -D 'LOCK_A_WIPER_PIN(lock)=(16+10*(lock))'
+ * -D 'LOCK_SERVO_PIN(lock)=(22+6*(lock))'</code>; a lock's B wiper is the pin
+ * after its A wiper.
+ *
+ * The dial arithmetic is specialized for the configured dial: a power-of-two
+ * dial wraps with a mask, and any other dial wraps with a multiplication by a
+ * precomputed reciprocal, so neither needs a division on the hot path.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_LOCK_CONFIG_H
+#define COMBOLOCK_LOCK_CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef COMBINATION_LENGTH
+#define COMBINATION_LENGTH (3)
+#endif
+
+#ifndef DIAL_POSITIONS
+#define DIAL_POSITIONS (16)
+#endif
+
+// the dial must pass number i this many times; i counts from 0
+#ifndef REQUIRED_PASSES
+#define REQUIRED_PASSES(i) (COMBINATION_LENGTH - (i))
+#endif
+
+// when true, the last number must be passed exactly REQUIRED_PASSES times rather than at least that many
+#ifndef LAST_NUMBER_REQUIRES_EXACT_PASSES
+#define LAST_NUMBER_REQUIRES_EXACT_PASSES (true)
+#endif
+
+#ifndef MAXIMUM_BAD_ATTEMPTS
+#define MAXIMUM_BAD_ATTEMPTS (3)
+#endif
+
+// the number the lock falls back to when no combination has been stored: 05-10-15 on the default lock
+#ifndef DEFAULT_COMBINATION_NUMBER
+#define DEFAULT_COMBINATION_NUMBER(i) ((5 * ((i) + 1)) % DIAL_POSITIONS)
+#endif
+
+#ifndef NUMBER_OF_LOCKS
+#define NUMBER_OF_LOCKS (1)
+#endif
+
+#define MAXIMUM_NUMBER_OF_LOCKS (8)
+
+#if NUMBER_OF_LOCKS > 1 && !(defined(LOCK_A_WIPER_PIN) && defined(LOCK_SERVO_PIN))
+#error "a bank of locks must define LOCK_A_WIPER_PIN(lock) and LOCK_SERVO_PIN(lock)"
+#endif
+
+#ifndef LOCK_A_WIPER_PIN
+#define LOCK_A_WIPER_PIN(lock) (16)
+#endif
+
+#ifndef LOCK_SERVO_PIN
+#define LOCK_SERVO_PIN(lock) (22)
+#endif
+
+#define DIGITS_PER_NUMBER ((DIAL_POSITIONS) > 100 ? 3 : (DIAL_POSITIONS) > 10 ? 2 : 1)
+#define COMBINATION_DIGITS (COMBINATION_LENGTH * DIGITS_PER_NUMBER)
+// numbers separated by dashes, as in "05-10-15"
+#define COMBINATION_TEXT_LENGTH (COMBINATION_LENGTH * (DIGITS_PER_NUMBER + 1) - 1)
+
+_Static_assert(COMBINATION_LENGTH >= 1, "a combination needs at least one number");
+_Static_assert(DIAL_POSITIONS >= 2 && DIAL_POSITIONS <= 255, "dial positions must fit in a uint8_t");
+_Static_assert(NUMBER_OF_LOCKS >= 1 && NUMBER_OF_LOCKS <= MAXIMUM_NUMBER_OF_LOCKS,
+               "the bank must have between 1 and MAXIMUM_NUMBER_OF_LOCKS locks");
+_Static_assert(COMBINATION_TEXT_LENGTH <= 21, "the combination must fit on one display row");
+
+#define DIAL_IS_POWER_OF_TWO (((DIAL_POSITIONS) & ((DIAL_POSITIONS) - 1)) == 0)
+// ceil(2^24 / DIAL_POSITIONS) gives an exact quotient for every position below 2 * DIAL_POSITIONS
+#define DIAL_RECIPROCAL ((uint32_t) (((1UL << 24) + (DIAL_POSITIONS) - 1) / (DIAL_POSITIONS)))
+
+/**
+ * Wraps a position onto the dial.
+ *
+ * @param position A position less than <code>2 * DIAL_POSITIONS</code>
+ * @return The position modulo <code>DIAL_POSITIONS</code>
+ */
+static inline uint8_t dial_wrap(uint32_t position) {
+#if DIAL_IS_POWER_OF_TWO
+    return (uint8_t) (position & (DIAL_POSITIONS - 1));
+#else
+    uint32_t quotient = (position * DIAL_RECIPROCAL) >> 24;
+    return (uint8_t) (position - quotient * DIAL_POSITIONS);
+#endif
+}
+
+static inline uint8_t dial_step_clockwise(uint8_t position) {
+    return dial_wrap(position + 1U);
+}
+
+static inline uint8_t dial_step_counterclockwise(uint8_t position) {
+    return dial_wrap(position + (DIAL_POSITIONS - 1U));
+}
+
+#endif //COMBOLOCK_LOCK_CONFIG_H
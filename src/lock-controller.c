@@ -8,6 +8,24 @@
  *
  * @brief Code to implement the "combination lock" mode.
  *
+ * The controller is a table-driven state machine. Each pass, the current
+ * mode's poll function reads the inputs and reports at most one event; the
+ * (mode, event) pair selects a transition from a table that is built at
+ * compile time. A transition to a different mode runs the old mode's exit
+ * action, the transition's action, and the new mode's entry action, so
+ * display writes, LEDs, and servo commands happen once per transition rather
+ * than once per pass.
+ *
+ * The controller drives a bank of <code>NUMBER_OF_LOCKS</code> locks. Each
+ * lock's state is kept in arrays indexed by the lock, and each pass services
+ * every lock in turn, with <code>lock</code> naming the lock being serviced so
+ * that the actions need no arguments. The locks share one console: the
+ * buttons, switches, keypad, LEDs, and display belong to the focused lock,
+ * which is the lock whose dial turned most recently, except that a lock
+ * changing its combination keeps the console until it is done, and an alarmed
+ * lock keeps it for good. The other locks still follow their dials and finish
+ * what they were doing.
+ *
  ******************************************************************************/
 
 /*
@@ -17,368 +35,761 @@
 
 // clang-format off
 #include <CowPi.h>
+#include "audit-log.h"
+#include "config-store.h"
+#include "cooperative-tasks.h"
+#include "crc32.h"
 #include "display.h"
+#include "format.h"
+#include "keypad.h"
+#include "lock-config.h"
 #include "lock-controller.h"
+#include "lock-bank.h"
 #include "rotary-encoder.h"
+#include "encoder-bank.h"
 #include "servomotor.h"
+#include "servo-bank.h"
+#include "telemetry.h"
+#include "trace.h"
 // clang-format on
 
-static uint8_t combination[3] __attribute__((section(".uninitialized_ram.")));
+static uint8_t combination[NUMBER_OF_LOCKS][COMBINATION_LENGTH];
 
-typedef enum { LOCKED,
-               UNLOCKED,
-               ALARMED,
-               CHANGING } lock_mode_t;
+static uint8_t lock;                // the lock being serviced
+static uint8_t focused_lock;        // the lock that the console belongs to
 
-static volatile lock_mode_t mode;
-static volatile uint8_t entry[3];
-static volatile bool entry_in_progress;
+static volatile lock_mode_t mode[NUMBER_OF_LOCKS];
+static volatile uint8_t entry[NUMBER_OF_LOCKS][COMBINATION_LENGTH];
+static volatile bool entry_in_progress[NUMBER_OF_LOCKS];
 
-static volatile uint8_t digit_index;
-static volatile uint8_t current_digit;
-static volatile uint8_t bad_tries;
-static volatile uint8_t pass_count[3];
+static volatile uint8_t digit_index[NUMBER_OF_LOCKS];
+static volatile uint8_t current_digit[NUMBER_OF_LOCKS];
+static volatile uint8_t bad_tries[NUMBER_OF_LOCKS];
+static volatile uint8_t pass_count[NUMBER_OF_LOCKS][COMBINATION_LENGTH];
 
-static volatile char new_combo[6];
-static volatile char confirm_combo[6];
+// only the focused lock can be changing its combination, so there is one of each of these
+static volatile char new_combo[COMBINATION_DIGITS];
+static volatile char confirm_combo[COMBINATION_DIGITS];
 static volatile uint8_t change_phase;
 static volatile uint8_t change_index;
 
-static volatile cowpi_timer_t *timer;
+#define EVENT_BAD_ATTEMPT (1 << 0)
+#define EVENT_ALARM (1 << 1)
+#define EVENT_CHANGE_REQUESTED (1 << 2)
+
+static volatile task_events_t events[NUMBER_OF_LOCKS];
+static task_t feedback_task[NUMBER_OF_LOCKS];
+static task_t alarm_task[NUMBER_OF_LOCKS];
+static task_t change_task;
+
+static uint32_t worst_step_us;
+
+#define CHECKPOINT_MAGIC (0x4B434F4C)   // "LOCK"
+#define CHECKPOINT_VERSION (3)
+
+/*
+ * The controller state that must survive a brownout or watchdog reset, kept in
+ * RAM that the startup code does not clear. It is rewritten after every
+ * transition and every combination change.
+ */
+struct checkpoint {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t number_of_locks;
+    uint8_t combination_length;
+    uint8_t dial_positions;
+    uint8_t mode[NUMBER_OF_LOCKS];
+    uint8_t bad_tries[NUMBER_OF_LOCKS];
+    uint8_t combination[NUMBER_OF_LOCKS][COMBINATION_LENGTH];
+    uint32_t crc;
+};
+
+static struct checkpoint checkpoint __attribute__((section(".uninitialized_ram.")));
 
 static bool is_attempt_correct(void);
-static void handle_attempt(void);
+static lock_event_t handle_attempt(void);
+static void report_bad_attempt(void);
 static void display_entry(void);
-static uint32_t get_microseconds(void);
+static void display_combo_entry(int row, char const volatile combo[COMBINATION_DIGITS]);
+static bool is_valid_combination(uint8_t const candidate[COMBINATION_LENGTH]);
 static void reset_entry();
+static void reset_combination(void);
+#if NUMBER_OF_LOCKS > 1
+static void take_console(void);
+#endif
+static void show(int row, char const *string);
+static void show_bad_attempts(void);
+static void light_left_led(bool is_lit);
+static void light_right_led(bool is_lit);
+static task_status_t blink_bad_attempts(task_t *task);
+static task_status_t sound_alarm(task_t *task);
+static task_status_t change_combination(task_t *task);
+static void commit_combination_change(void);
+static void clear_bad_attempts(void);
+static void report_unlock(void);
+static void raise_alarm(void);
+static void save_checkpoint(void);
+static bool restore_checkpoint(void);
+static void trace_inputs(void);
+
+static void enter_locked(void);
+static void enter_unlocked(void);
+static void enter_alarmed(void);
+static void enter_changing(void);
+static void exit_changing(void);
+static lock_event_t poll_locked(direction_t dir);
+static lock_event_t poll_unlocked(direction_t dir);
+static lock_event_t poll_alarmed(direction_t dir);
+static lock_event_t poll_changing(direction_t dir);
+
+/*
+ * (mode, event) -> (action, next mode). Any pair not listed here is ignored.
+ * A transition whose next mode is the current mode is internal: only its
+ * action runs.
+ */
+#define LOCK_TRANSITIONS(TRANSITION)                                         \
+    TRANSITION(LOCKED,   ATTEMPT_ACCEPTED,  report_unlock,             UNLOCKED) \
+    TRANSITION(LOCKED,   ATTEMPT_REJECTED,  report_bad_attempt,        LOCKED)   \
+    TRANSITION(LOCKED,   TOO_MANY_ATTEMPTS, raise_alarm,               ALARMED)  \
+    TRANSITION(UNLOCKED, RELOCK_REQUESTED,  clear_bad_attempts,        LOCKED)   \
+    TRANSITION(UNLOCKED, CHANGE_REQUESTED,  NULL,                      CHANGING) \
+    TRANSITION(CHANGING, CHANGE_FINISHED,   commit_combination_change, UNLOCKED)
+
+struct transition {
+    void (*action)(void);
+    lock_mode_t next_mode;
+    bool is_defined;
+};
+
+#define TRANSITION_TABLE_ENTRY(from, event, transition_action, to) \
+    [from][event] = {.action = (transition_action), .next_mode = (to), .is_defined = true},
+
+static struct transition const transitions[NUMBER_OF_LOCK_MODES][NUMBER_OF_LOCK_EVENTS] = {
+    LOCK_TRANSITIONS(TRANSITION_TABLE_ENTRY)
+};
+
+struct mode_behavior {
+    void (*on_entry)(void);
+    void (*on_exit)(void);
+    lock_event_t (*poll)(direction_t dir);
+};
+
+static struct mode_behavior const behaviors[NUMBER_OF_LOCK_MODES] = {
+    [LOCKED] = {.on_entry = enter_locked, .on_exit = NULL, .poll = poll_locked},
+    [UNLOCKED] = {.on_entry = enter_unlocked, .on_exit = NULL, .poll = poll_unlocked},
+    [ALARMED] = {.on_entry = enter_alarmed, .on_exit = NULL, .poll = poll_alarmed},
+    [CHANGING] = {.on_entry = enter_changing, .on_exit = exit_changing, .poll = poll_changing},
+};
 
 uint8_t const *get_combination() {
-    return combination;
+    return combination[0];
 }
 
 void force_combination_reset() {
-    combination[0] = 5;
-    combination[1] = 10;
-    combination[2] = 15;
+    for (lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        reset_combination();
+    }
+    save_checkpoint();
 }
 
-void initialize_lock_controller() {
-    timer = (cowpi_timer_t *)(0x40054000);
+lock_mode_t get_lock_mode() {
+    return mode[focused_lock];
+}
+
+lock_mode_t get_bank_mode() {
+    static uint8_t const urgency[NUMBER_OF_LOCK_MODES] = {
+        [LOCKED] = 0,
+        [UNLOCKED] = 1,
+        [CHANGING] = 2,
+        [ALARMED] = 3,
+    };
+    lock_mode_t bank_mode = LOCKED;
+    for (uint8_t i = 0; i < NUMBER_OF_LOCKS; i++) {
+        if (urgency[mode[i]] > urgency[bank_mode]) {
+            bank_mode = mode[i];
+        }
+    }
+    return bank_mode;
+}
+
+uint32_t get_worst_control_step_us() {
+    return worst_step_us;
+}
+
+void discard_lock_checkpoint() {
+    memset(&checkpoint, 0, sizeof(checkpoint));
+}
 
-    mode = LOCKED;
-    bad_tries = 0;
+bool checkpoint_lock_state(uint8_t which, uint8_t const *new_combination, lock_mode_t new_mode, uint8_t tries) {
+    if (which >= NUMBER_OF_LOCKS || new_mode >= NUMBER_OF_LOCK_MODES || new_mode == CHANGING
+        || !is_valid_combination(new_combination)) {
+        return false;
+    }
+    memcpy(combination[which], new_combination, COMBINATION_LENGTH);
+    mode[which] = new_mode;
+    bad_tries[which] = tries;
+    save_checkpoint();
+    return true;
+}
 
+#ifdef PIO_UNIT_TESTING
+// lets the on-target benchmarks time each mode's step without dialing into it
+bool force_lock_mode(unsigned int new_mode) {
+    if (new_mode >= NUMBER_OF_LOCK_MODES) {
+        return false;
+    }
+    lock = 0;
+    if (behaviors[mode[lock]].on_exit) {
+        behaviors[mode[lock]].on_exit();
+    }
+    task_reset(&alarm_task[lock]);
+    mode[lock] = new_mode;
+    behaviors[mode[lock]].on_entry();
+    return true;
+}
+#endif
+
+void initialize_lock_controller() {
     change_phase = 0;
     change_index = 0;
 
-    reset_entry();
+    task_reset(&change_task);
+    worst_step_us = 0;
+    focused_lock = 0;
 
-    cowpi_illuminate_left_led();
-    cowpi_deluminate_right_led();
-
-    rotate_full_clockwise();
+    bool is_warm_reset = restore_checkpoint();
+    if (!is_warm_reset) {
+        // cold start: flash survives a power cycle
+        initialize_config_store();
+    }
+    initialize_audit_log();
+    audit_log_record(AUDIT_BOOT, 0, is_warm_reset);
+    for (lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        events[lock] = 0;
+        task_reset(&feedback_task[lock]);
+        task_reset(&alarm_task[lock]);
+        if (is_warm_reset) {
+            // warm reset: resume where we were, including an alarm in progress
+            if (mode[lock] == CHANGING) {
+                // a half-typed combination is not worth resuming
+                mode[lock] = UNLOCKED;
+            }
+        } else {
+            if (!load_lock_combination(lock, combination[lock]) || !is_valid_combination(combination[lock])) {
+                reset_combination();
+            }
+            mode[lock] = LOCKED;
+            bad_tries[lock] = 0;
+        }
+        behaviors[mode[lock]].on_entry();
+    }
+#if NUMBER_OF_LOCKS > 1
+    // an alarm resumed by a warm reset gets the console
+    lock = 0;
+    for (uint8_t i = NUMBER_OF_LOCKS; i-- > 0;) {
+        if (mode[i] == ALARMED) {
+            lock = i;
+        }
+    }
+    take_console();
+#endif
+    save_checkpoint();
+}
 
-    if (combination[0] > 15 || combination[1] > 15 || combination[2] > 15) {
-        force_combination_reset();
+static void dispatch(lock_event_t event) {
+    lock_mode_t current_mode = mode[lock];
+    struct transition const *transition = &transitions[current_mode][event];
+    if (!transition->is_defined) {
+        return;
+    }
+    bool is_external = (transition->next_mode != current_mode);
+    trace_record(TRACE_TRANSITION, (lock << 12) | (event << 8) | (transition->next_mode << 4) | current_mode);
+    if (is_external && behaviors[current_mode].on_exit) {
+        behaviors[current_mode].on_exit();
+    }
+    if (transition->action) {
+        transition->action();
     }
+    if (is_external) {
+        mode[lock] = transition->next_mode;
+        if (behaviors[mode[lock]].on_entry) {
+            behaviors[mode[lock]].on_entry();
+        }
+    }
+    save_checkpoint();
 }
 
 void control_lock() {
-    direction_t dir = get_direction();
-
-    switch (mode) {
-    case LOCKED: {
-        // Display locked if no attempts have been made
-        if (bad_tries < 1) {
-            display_string(1, "LOCKED");
-            display_string(2, "");
+    uint32_t start_time = task_clock_us();
+    telemetry_begin_step();
+
+    trace_inputs();
+    for (lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        direction_t dir = get_direction_of(lock);
+#if NUMBER_OF_LOCKS > 1
+        // turning a dial brings its lock to the console, unless another lock is in the middle of a change or alarmed
+        if (dir != STATIONARY && lock != focused_lock && mode[focused_lock] != CHANGING
+            && mode[focused_lock] != ALARMED) {
+            take_console();
         }
-        // Handle dial rotations for each digit
-        if (dir != STATIONARY) {
-            switch (current_digit) {
-            case 0:
-                if (dir == CLOCKWISE) {
-                    entry[0] = (entry[0] + 1) % 16;
-                    if (entry[0] == combination[0])
-                        pass_count[0]++;
-                } else if (dir == COUNTERCLOCKWISE) {
-                    // Move on to digit #2
-                    current_digit = 1;
-                    entry[1] = entry[0];
-                    pass_count[1] = 0;
-                }
-                break;
-
-            case 1:
-                if (dir == COUNTERCLOCKWISE) {
-                    entry[1] = (entry[1] + 15) % 16;
-                    if (entry[1] == combination[1])
-                        pass_count[1]++;
-                } else if (dir == CLOCKWISE) {
-                    // Move on to digit #3
-                    current_digit = 2;
-                    entry[2] = entry[1];
-                    pass_count[2] = 0;
-                }
-                break;
-
-            case 2:
-                if (dir == CLOCKWISE) {
-                    entry[2] = (entry[2] + 1) % 16;
-                    if (entry[2] == combination[2])
-                        pass_count[2]++;
-                } else if (dir == COUNTERCLOCKWISE) {
-                    // Back to start
-                    reset_entry();
-                }
-                break;
-            }
-
-            // Refresh display for 1, 2 or 3 digits
-            digit_index = current_digit + 1;
-            display_entry();
+#endif
+        lock_event_t event = behaviors[mode[lock]].poll(dir);
+        if (event != NO_EVENT) {
+            dispatch(event);
         }
+        blink_bad_attempts(&feedback_task[lock]);
+    }
 
-        // If we've settled on the 3rd digit, wait for "enter"
-        if (current_digit == 2 && cowpi_left_button_is_pressed()) {
-            handle_attempt();
-        }
+    uint32_t step_time = task_clock_us() - start_time;
+    if (step_time > worst_step_us) {
+        worst_step_us = step_time;
+    }
+    telemetry_end_step();
+    telemetry_finish(TELEMETRY_CONTROL_LOCK, start_time);
+}
 
-        break;
+static void enter_locked(void) {
+    reset_entry();
+    light_left_led(true);
+    light_right_led(false);
+    rotate_full_clockwise_of(lock);
+    // a warm restore comes back here with the bad attempts still counted, and they stay on the display
+    if (bad_tries[lock] == 0) {
+        show(1, "LOCKED");
+        show(2, "");
+    } else {
+        show_bad_attempts();
     }
+}
 
-    case UNLOCKED: {
-        rotate_full_counterclockwise();
-        cowpi_deluminate_left_led();
-        cowpi_illuminate_right_led();
-        display_string(1, "OPEN");
+static void enter_unlocked(void) {
+    rotate_full_counterclockwise_of(lock);
+    light_left_led(false);
+    light_right_led(true);
+    show(1, "OPEN");
+}
 
-        // Both buttons down: relock
-        if (cowpi_left_button_is_pressed() && cowpi_right_button_is_pressed()) {
-            initialize_lock_controller();
-        }
+static void enter_alarmed(void) {
+    post_events(&events[lock], EVENT_ALARM);
+}
 
-        if (cowpi_left_switch_is_in_right_position() && cowpi_right_button_is_pressed()) {
-            mode = CHANGING;
-            display_string(2, "");
-            display_string(4, "__-__-__");
+static void enter_changing(void) {
+    show(2, "");
+    display_combo_entry(4, new_combo);
+    // keys pressed before the change began are not part of the new combination
+    discard_key_events();
+    post_events(&events[lock], EVENT_CHANGE_REQUESTED);
+}
+
+static void exit_changing(void) {
+    task_reset(&change_task);
+}
+
+static lock_event_t poll_locked(direction_t dir) {
+    // Handle dial rotations for each number: even-numbered ones are dialed clockwise, odd-numbered ones counterclockwise
+    if (dir != STATIONARY) {
+        uint8_t digit = current_digit[lock];
+        volatile uint8_t *dialed = entry[lock];
+        direction_t forward = (digit % 2 == 0) ? CLOCKWISE : COUNTERCLOCKWISE;
+        if (dir == forward) {
+            dialed[digit] = (forward == CLOCKWISE) ? dial_step_clockwise(dialed[digit])
+                                                   : dial_step_counterclockwise(dialed[digit]);
+            if (dialed[digit] == combination[lock][digit])
+                pass_count[lock][digit]++;
+        } else if (digit + 1 < COMBINATION_LENGTH) {
+            // Reversing moves on to the next number
+            current_digit[lock] = digit + 1;
+            dialed[digit + 1] = dialed[digit];
+            pass_count[lock][digit + 1] = 0;
+        } else {
+            // Back to start
+            reset_entry();
         }
 
-        break;
+        // Refresh display for however many numbers have been started
+        digit_index[lock] = current_digit[lock] + 1;
+        display_entry();
     }
 
-    case ALARMED: {
-        // Static across calls to keep track of blink timing & state
-        static uint16_t elapsed_ms = 0;
-        static bool leds_on = true;
+    // If we've settled on the last number, wait for "enter" from the console
+    if (current_digit[lock] == COMBINATION_LENGTH - 1 && lock == focused_lock && cowpi_left_button_is_pressed()) {
+        return handle_attempt();
+    }
+    return NO_EVENT;
+}
 
-        // Make sure the display shows ALERT!
-        display_string(1, "ALERT!");
+static lock_event_t poll_unlocked(direction_t dir) {
+    if (lock != focused_lock) {
+        return NO_EVENT;
+    }
+    // Both buttons down: relock
+    if (cowpi_left_button_is_pressed() && cowpi_right_button_is_pressed()) {
+        return RELOCK_REQUESTED;
+    }
+    if (cowpi_left_switch_is_in_right_position() && cowpi_right_button_is_pressed()) {
+        return CHANGE_REQUESTED;
+    }
+    return NO_EVENT;
+}
 
-        // Accumulate our 100 ms ticks
-        elapsed_ms += 100;
-        if (elapsed_ms >= 250) {
-            elapsed_ms = 0;
-            leds_on = !leds_on;
-            if (leds_on) {
-                cowpi_illuminate_left_led();
-                cowpi_illuminate_right_led();
-            } else {
-                cowpi_deluminate_left_led();
-                cowpi_deluminate_right_led();
-            }
-        }
-        break;
+static lock_event_t poll_alarmed(direction_t dir) {
+    sound_alarm(&alarm_task[lock]);
+    return NO_EVENT;
+}
+
+static lock_event_t poll_changing(direction_t dir) {
+    // When switch goes back to left, try to commit
+    if (cowpi_left_switch_is_in_left_position()) {
+        return CHANGE_FINISHED;
     }
+    change_combination(&change_task);
+    return NO_EVENT;
+}
+
+static task_status_t blink_bad_attempts(task_t *task) {
+    static uint8_t blinks[NUMBER_OF_LOCKS];
+    TASK_BEGIN(task);
+    AWAIT_EVENT(task, &events[lock], EVENT_BAD_ATTEMPT);
+    // Blink LED the number of bad attempts
+    for (blinks[lock] = 0; blinks[lock] < bad_tries[lock] && bad_tries[lock] < MAXIMUM_BAD_ATTEMPTS; blinks[lock]++) {
+        light_left_led(true);
+        light_right_led(true);
+        AWAIT_DEADLINE(task, 250000);
+        light_left_led(false);
+        light_right_led(false);
+        show(5, "");
+        AWAIT_DEADLINE(task, 250000);
+    }
+    if (mode[lock] == LOCKED) {
+        light_left_led(true);
+    }
+    TASK_END(task);
+}
 
-    case CHANGING: {
-        static char last_key = '\0';
-        char raw = cowpi_get_keypress();
-        bool new_k = (raw != '\0' && last_key == '\0');
-        last_key = raw;
+static bool leds_on[NUMBER_OF_LOCKS];
+
+static task_status_t sound_alarm(task_t *task) {
+    TASK_BEGIN(task);
+    AWAIT_EVENT(task, &events[lock], EVENT_ALARM);
+    show(1, "ALERT!");
+    leds_on[lock] = true;
+    light_left_led(true);
+    light_right_led(true);
+    while (mode[lock] == ALARMED) {
+        AWAIT_DEADLINE(task, 250000);
+        leds_on[lock] = !leds_on[lock];
+        light_left_led(leds_on[lock]);
+        light_right_led(leds_on[lock]);
+    }
+    TASK_END(task);
+}
+
+static task_status_t change_combination(task_t *task) {
+    static char key;
+    TASK_BEGIN(task);
+    AWAIT_EVENT(task, &events[lock], EVENT_CHANGE_REQUESTED);
 
+    // first entry
+    change_phase = 0;
+    change_index = 0;
+    for (int i = 0; i < COMBINATION_DIGITS; i++)
+        new_combo[i] = 0xFF;
+    show(1, "ENTER");
+    display_combo_entry(4, new_combo);
+    while (change_index < COMBINATION_DIGITS) {
+        AWAIT_KEY(task, key);
         // Only accept numeric digits 0–9
-        uint8_t digit = 0xFF;
-        if (new_k && raw >= '0' && raw <= '9') {
-            digit = raw - '0';
+        if (key >= '0' && key <= '9') {
+            new_combo[change_index++] = key - '0';
+            display_combo_entry(4, new_combo);
         }
+    }
 
-        // When switch goes back to left, try to commit
-        if (cowpi_left_switch_is_in_left_position()) {
-            // Incomplete if still in first entry or confirm < 6 digits
-            bool incomplete = (change_phase == 0) || (change_phase == 1 && change_index < 6);
-
-            // Match only if all six digits equal
-            bool match = true;
-            for (int i = 0; i < 6; i++) {
-                if ((new_combo[i] != confirm_combo[i]) && match) {
-                    match = false;
-                }
-            }
+    // confirmation entry
+    change_phase = 1;
+    change_index = 0;
+    for (int i = 0; i < COMBINATION_DIGITS; i++)
+        confirm_combo[i] = 0xFF;
+    show(1, "RE-ENTER");
+    while (change_index < COMBINATION_DIGITS) {
+        AWAIT_KEY(task, key);
+        if (key >= '0' && key <= '9') {
+            confirm_combo[change_index++] = key - '0';
+            display_combo_entry(5, confirm_combo);
+        }
+    }
+    TASK_END(task);
+}
 
-            // Valid only if all digits are lower then 15
-            bool invalid = false;
-            for (int i = 0; i < 3; i++) {
-                int val = new_combo[2 * i] * 10 + new_combo[2 * i + 1];
-                if ((val > 15) && !invalid) {
-                    invalid = true;
-                }
-            }
+static void commit_combination_change(void) {
+    // Incomplete if still in first entry or confirmation is short
+    bool incomplete = (change_phase == 0) || (change_phase == 1 && change_index < COMBINATION_DIGITS);
 
-            if (incomplete || !match || invalid) {
-                display_string(2, "NO CHANGE");
-                display_string(4, "");
-                display_string(5, "");
-            } else {
-                for (int i = 0; i < 3; i++) {
-                    combination[i] = new_combo[2 * i] * 10 + new_combo[2 * i + 1];
-                }
-                display_string(2, "CHANGED");
-                display_string(5, "");
-            }
+    // Match only if all digits equal
+    bool match = true;
+    for (int i = 0; i < COMBINATION_DIGITS; i++) {
+        if ((new_combo[i] != confirm_combo[i]) && match) {
+            match = false;
+        }
+    }
 
-            mode = UNLOCKED;
-            change_phase = change_index = 0;
-            last_key = '\0';
-            break;
+    uint8_t candidate[COMBINATION_LENGTH];
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        int val = 0;
+        for (int j = 0; j < DIGITS_PER_NUMBER; j++) {
+            val = val * 10 + new_combo[DIGITS_PER_NUMBER * i + j];
         }
+        // anything too large for the dial (including unentered digits) wraps to an invalid value
+        candidate[i] = (val < DIAL_POSITIONS) ? val : 0xFF;
+    }
 
-        // still CHANGING: collect digits
-        if (change_phase == 0) {
-            // start first entry
-            if (change_index == 0) {
-                display_string(1, "ENTER");
-                display_string(4, "__-__-__");
-                for (int i = 0; i < 6; i++)
-                    new_combo[i] = 0xFF;
-            }
-            if (digit <= 9 && change_index < 6) {
-                new_combo[change_index++] = digit;
-            }
-            // update display after each press
-            {
-                char buf[9];
-                for (int grp = 0; grp < 3; grp++) {
-                    int idx = 2 * grp;
-                    // tens digit
-                    buf[3 * grp + 0] = (change_index > idx)
-                                           ? ('0' + new_combo[idx])
-                                           : '_';
-                    // ones digit
-                    buf[3 * grp + 1] = (change_index > idx + 1)
-                                           ? ('0' + new_combo[idx + 1])
-                                           : '_';
-                    // dash or terminator
-                    buf[3 * grp + 2] = (grp < 2 ? '-' : '\0');
-                }
-                buf[8] = '\0';
-                display_string(4, buf);
-            }
-            // once six digits entered, go to confirmation
-            if (change_index == 6) {
-                change_phase = 1;
-                change_index = 0;
-                display_string(1, "RE-ENTER");
-                for (int i = 0; i < 6; i++)
-                    confirm_combo[i] = 0xFF;
-            }
+    // Valid only if every number is on the dial
+    bool invalid = !is_valid_combination(candidate);
 
-        } else {
-            // confirmation entry
-            if (digit <= 9 && change_index < 6) {
-                confirm_combo[change_index++] = digit;
-            }
-            // update display just like above
-            {
-                char buf[9];
-                for (int grp = 0; grp < 3; grp++) {
-                    int idx = 2 * grp;
-                    buf[3 * grp + 0] = (change_index > idx)
-                                           ? ('0' + confirm_combo[idx])
-                                           : '_';
-                    buf[3 * grp + 1] = (change_index > idx + 1)
-                                           ? ('0' + confirm_combo[idx + 1])
-                                           : '_';
-                    buf[3 * grp + 2] = (grp < 2 ? '-' : '\0');
-                }
-                buf[8] = '\0';
-                display_string(5, buf);
-            }
+    if (incomplete || !match || invalid) {
+        show(2, "NO CHANGE");
+        show(4, "");
+        show(5, "");
+    } else {
+        for (int i = 0; i < COMBINATION_LENGTH; i++) {
+            combination[lock][i] = candidate[i];
         }
-        break;
+        save_lock_combination(lock, combination[lock]);
+        save_checkpoint();
+        audit_log_record(AUDIT_COMBINATION_CHANGED, lock, 0);
+        show(2, "CHANGED");
+        show(5, "");
     }
+
+    change_phase = change_index = 0;
+}
+
+static void display_combo_entry(int row, char const volatile combo[COMBINATION_DIGITS]) {
+    char buf[COMBINATION_TEXT_LENGTH + 1];
+    int position = 0;
+    for (int i = 0; i < COMBINATION_DIGITS; i++) {
+        if (i > 0 && i % DIGITS_PER_NUMBER == 0) {
+            buf[position++] = '-';
+        }
+        buf[position++] = (change_index > i) ? ('0' + combo[i]) : '_';
     }
+    buf[position] = '\0';
+    show(row, buf);
 }
 
 static void display_entry(void) {
-    char buf[9] = {' ', ' ', '-', ' ', ' ', '-', ' ', ' ', '\0'};
-    char const digits[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
-    for (int i = 0; i < 3 && i < digit_index; i++) {
-        uint8_t v = entry[i];
-        buf[3 * i] = digits[(v / 10)];
-        buf[3 * i + 1] = digits[v % 10];
+    char buf[COMBINATION_TEXT_LENGTH + 1];
+    int position = 0;
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        if (i > 0) {
+            buf[position++] = '-';
+        }
+        uint8_t v = entry[lock][i];
+        for (int j = DIGITS_PER_NUMBER - 1; j >= 0; j--) {
+            buf[position + j] = (i < digit_index[lock]) ? ('0' + v % 10) : ' ';
+            v /= 10;
+        }
+        position += DIGITS_PER_NUMBER;
     }
-    display_string(4, buf);
+    buf[position] = '\0';
+    show(4, buf);
 }
 
 static void reset_entry() {
-    entry[0] = entry[1] = entry[2] = 0;
-    pass_count[0] = pass_count[1] = pass_count[2] = 0;
-    current_digit = 0;
-    digit_index = 0;
-    entry_in_progress = true;
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        entry[lock][i] = 0;
+        pass_count[lock][i] = 0;
+    }
+    current_digit[lock] = 0;
+    digit_index[lock] = 0;
+    entry_in_progress[lock] = true;
     display_entry();
 }
 
+static void reset_combination(void) {
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        combination[lock][i] = DEFAULT_COMBINATION_NUMBER(i);
+    }
+    save_lock_combination(lock, combination[lock]);
+}
+
 static bool is_attempt_correct(void) {
-    return (pass_count[0] >= 3 &&
-            pass_count[1] >= 2 &&
-            pass_count[2] == 1) &&
-           (entry[0] == combination[0] &&
-            entry[1] == combination[1] &&
-            entry[2] == combination[2]);
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        if (entry[lock][i] != combination[lock][i]) {
+            return false;
+        }
+        bool is_last = (i == COMBINATION_LENGTH - 1);
+        if (is_last && LAST_NUMBER_REQUIRES_EXACT_PASSES) {
+            if (pass_count[lock][i] != REQUIRED_PASSES(i)) {
+                return false;
+            }
+        } else if (pass_count[lock][i] < REQUIRED_PASSES(i)) {
+            return false;
+        }
+    }
+    return true;
 }
 
-static uint32_t get_microseconds(void) {
-    return timer->raw_lower_word;
+static bool is_valid_combination(uint8_t const candidate[COMBINATION_LENGTH]) {
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        if (candidate[i] >= DIAL_POSITIONS) {
+            return false;
+        }
+    }
+    return true;
 }
 
-static void handle_attempt(void) {
+static lock_event_t handle_attempt(void) {
     if (is_attempt_correct()) {
-        mode = UNLOCKED;
-    } else {
-        bad_tries++;
-        char buf[21];
-        snprintf(buf, sizeof(buf), "BAD ATTEMPT #%u", bad_tries);
-        display_string(1, buf);
-
-        // Blink LED the number of bad attempts
-        for (uint8_t i = 0; i < bad_tries && bad_tries < 3; i++) {
-            cowpi_illuminate_left_led();
-            cowpi_illuminate_right_led();
-
-            uint32_t start_time = get_microseconds();
-            while ((get_microseconds() - start_time) < 250000) {
-                // Busy wait loop
-            }
+        return ATTEMPT_ACCEPTED;
+    }
+    return (bad_tries[lock] + 1 >= MAXIMUM_BAD_ATTEMPTS) ? TOO_MANY_ATTEMPTS : ATTEMPT_REJECTED;
+}
+
+static void report_unlock(void) {
+    audit_log_record(AUDIT_UNLOCKED, lock, 0);
+}
+
+static void report_bad_attempt(void) {
+    bad_tries[lock]++;
+    audit_log_record(AUDIT_BAD_ATTEMPT, lock, bad_tries[lock]);
+    show_bad_attempts();
 
-            cowpi_deluminate_left_led();
-            cowpi_deluminate_right_led();
-            display_string(5, "");
+    if (bad_tries[lock] < MAXIMUM_BAD_ATTEMPTS) {
+        // the feedback task blinks the LEDs while the dial stays responsive
+        post_events(&events[lock], EVENT_BAD_ATTEMPT);
+    }
+    reset_entry();
+}
 
-            start_time = get_microseconds();
-            while ((get_microseconds() - start_time) < 250000) {
-                // Busy wait loop
+static void show_bad_attempts(void) {
+    char buf[21];
+    FORMAT(buf, "BAD ATTEMPT #", bad_tries[lock]);
+    show(1, buf);
+}
+
+static void raise_alarm(void) {
+    report_bad_attempt();
+    audit_log_record(AUDIT_ALARM, lock, 0);
+}
+
+#if NUMBER_OF_LOCKS > 1
+// Gives the console to the lock being serviced, redrawing the display and LEDs for it
+static void take_console(void) {
+    focused_lock = lock;
+    char buf[21];
+    FORMAT(buf, "LOCK ", lock + 1);
+    display_string(0, buf);
+    switch (mode[lock]) {
+        case LOCKED:
+            if (bad_tries[lock] > 0) {
+                show_bad_attempts();
+            } else {
+                show(1, "LOCKED");
             }
-        }
+            light_left_led(true);
+            light_right_led(false);
+            break;
+        case UNLOCKED:
+            show(1, "OPEN");
+            light_left_led(false);
+            light_right_led(true);
+            break;
+        case ALARMED:
+            show(1, "ALERT!");
+            light_left_led(leds_on[lock]);
+            light_right_led(leds_on[lock]);
+            break;
+        default:
+            break;
+    }
+    show(2, "");
+    display_entry();
+    show(5, "");
+}
+#endif
+
+// The console's outputs belong to the focused lock; the other locks' writes are dropped
+static void show(int row, char const *string) {
+    if (lock == focused_lock) {
+        display_string(row, string);
+    }
+}
 
+static void light_left_led(bool is_lit) {
+    if (lock != focused_lock) {
+        return;
+    }
+    if (is_lit) {
         cowpi_illuminate_left_led();
+    } else {
+        cowpi_deluminate_left_led();
+    }
+}
+
+static void light_right_led(bool is_lit) {
+    if (lock != focused_lock) {
+        return;
+    }
+    if (is_lit) {
+        cowpi_illuminate_right_led();
+    } else {
+        cowpi_deluminate_right_led();
+    }
+}
 
-        if (bad_tries >= 3) {
-            mode = ALARMED;
-            cowpi_illuminate_left_led();
-            cowpi_illuminate_right_led();
+static void trace_inputs(void) {
+#if TRACE_ENABLED
+    // the buttons and switches are polled, so record them when they change to make a trace replayable
+    static uint16_t previous_inputs = 0;
+    uint16_t inputs = (cowpi_left_button_is_pressed() ? TRACE_INPUT_LEFT_BUTTON_PRESSED : 0)
+                      | (cowpi_right_button_is_pressed() ? TRACE_INPUT_RIGHT_BUTTON_PRESSED : 0)
+                      | (cowpi_left_switch_is_in_right_position() ? TRACE_INPUT_LEFT_SWITCH_RIGHT : 0)
+                      | (cowpi_right_switch_is_in_right_position() ? TRACE_INPUT_RIGHT_SWITCH_RIGHT : 0);
+    if (inputs != previous_inputs) {
+        trace_record(TRACE_INPUTS, inputs);
+        previous_inputs = inputs;
+    }
+#endif
+}
+
+static void clear_bad_attempts(void) {
+    bad_tries[lock] = 0;
+}
+
+static void save_checkpoint(void) {
+    memset(&checkpoint, 0, sizeof(checkpoint));
+    checkpoint.magic = CHECKPOINT_MAGIC;
+    checkpoint.version = CHECKPOINT_VERSION;
+    checkpoint.number_of_locks = NUMBER_OF_LOCKS;
+    checkpoint.combination_length = COMBINATION_LENGTH;
+    checkpoint.dial_positions = DIAL_POSITIONS;
+    for (uint8_t i = 0; i < NUMBER_OF_LOCKS; i++) {
+        checkpoint.mode[i] = mode[i];
+        checkpoint.bad_tries[i] = bad_tries[i];
+    }
+    memcpy(checkpoint.combination, combination, sizeof(combination));
+    checkpoint.crc = crc32(&checkpoint, offsetof(struct checkpoint, crc));
+}
+
+static bool restore_checkpoint(void) {
+    if (checkpoint.magic != CHECKPOINT_MAGIC
+        || checkpoint.version != CHECKPOINT_VERSION
+        || checkpoint.crc != crc32(&checkpoint, offsetof(struct checkpoint, crc))
+        || checkpoint.number_of_locks != NUMBER_OF_LOCKS
+        || checkpoint.combination_length != COMBINATION_LENGTH
+        || checkpoint.dial_positions != DIAL_POSITIONS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < NUMBER_OF_LOCKS; i++) {
+        if (checkpoint.mode[i] >= NUMBER_OF_LOCK_MODES || !is_valid_combination(checkpoint.combination[i])) {
+            return false;
         }
-        reset_entry();
     }
+    for (uint8_t i = 0; i < NUMBER_OF_LOCKS; i++) {
+        mode[i] = (lock_mode_t) checkpoint.mode[i];
+        bad_tries[i] = checkpoint.bad_tries[i];
+    }
+    memcpy(combination, checkpoint.combination, sizeof(combination));
+    return true;
 }
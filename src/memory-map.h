@@ -0,0 +1,50 @@
+/**************************************************************************/
+/**
+ *
+ * @file memory-map.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Base addresses of the RP2040 peripherals that the lock accesses
+ *      directly rather than through the CowPi library.
+ *
+ * A host build predefines these (in its mock <code>CowPi.h</code>) so that the
+ * same code reads and writes mock registers instead.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_MEMORY_MAP_H
+#define COMBOLOCK_MEMORY_MAP_H
+
+// single-cycle I/O block: GPIO input and output registers
+#ifndef SIO_BASE_ADDRESS
+#define SIO_BASE_ADDRESS (0xD0000000)
+#endif
+
+// user bank I/O: GPIO functions and pin-change interrupts
+#ifndef IO_BANK0_BASE_ADDRESS
+#define IO_BANK0_BASE_ADDRESS (0x40014000)
+#endif
+
+// free-running microsecond timer
+#ifndef TIMER_BASE_ADDRESS
+#define TIMER_BASE_ADDRESS (0x40054000)
+#endif
+
+// Cortex-M0+ SysTick: 24-bit down-counter clocked by the processor
+#ifndef SYSTICK_BASE_ADDRESS
+#define SYSTICK_BASE_ADDRESS (0xE000E010)
+#endif
+
+// Cortex-M0+ NVIC: interrupt enables and priorities
+#ifndef NVIC_BASE_ADDRESS
+#define NVIC_BASE_ADDRESS (0xE000E100)
+#endif
+
+#endif //COMBOLOCK_MEMORY_MAP_H
@@ -0,0 +1,167 @@
+/**************************************************************************/
+/**
+ *
+ * @file pins.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Reads and writes of GPIO pins through the RP2040's single-cycle I/O
+ *      block, one load or one store per operation.
+ *
+ * The output functions write the SIO's set, clear, and toggle aliases of the
+ * output register, so that each changes only the pins in its mask with a
+ * single store. Unlike <code>output |= mask</code>, such a store cannot undo a
+ * change that an ISR makes to another pin between the read and the write.
+ * The input function reads every pin in its mask with a single load, so the
+ * pins are sampled at the same instant.
+ *
+ * Pass masks built from constants, such as
+ * <code>PIN_MASK(SERVO_PIN)</code>; the functions are always inlined, so the
+ * mask is folded into the instruction stream, and flash-safe ISRs may call
+ * them. C++ code may instead name the pins in
+ * the type, as in <code>Pins<16, 17>::read()</code>, which checks the pin
+ * numbers at compile time.
+ *
+ * These functions neither configure a pin's direction nor its pull resistors;
+ * use <code>cowpi_set_output_pins()</code> and its siblings for that.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_PINS_H
+#define COMBOLOCK_PINS_H
+
+#include <CowPi.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "memory-map.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUMBER_OF_GPIO_PINS (30)
+#define PIN_MASK(pin) (1u << (pin))
+
+#define SIO ((volatile cowpi_ioport_t *) (SIO_BASE_ADDRESS))
+
+/**
+ * Drives the pins in the mask high, leaving the other pins alone.
+ *
+ * @param pin_mask The pins to drive high
+ */
+static inline __attribute__((always_inline)) void set_output_pins(uint32_t pin_mask) {
+#ifdef COWPI_MOCK
+    // the mock's registers are plain memory, without the set alias's side effect
+    SIO->output |= pin_mask;
+#else
+    SIO->output_set = pin_mask;
+#endif
+}
+
+/**
+ * Drives the pins in the mask low, leaving the other pins alone.
+ *
+ * @param pin_mask The pins to drive low
+ */
+static inline __attribute__((always_inline)) void clear_output_pins(uint32_t pin_mask) {
+#ifdef COWPI_MOCK
+    SIO->output &= ~pin_mask;
+#else
+    SIO->output_clear = pin_mask;
+#endif
+}
+
+/**
+ * Inverts the pins in the mask, leaving the other pins alone.
+ *
+ * @param pin_mask The pins to invert
+ */
+static inline __attribute__((always_inline)) void toggle_output_pins(uint32_t pin_mask) {
+#ifdef COWPI_MOCK
+    SIO->output ^= pin_mask;
+#else
+    SIO->output_toggle = pin_mask;
+#endif
+}
+
+/**
+ * Samples the pins in the mask at one instant.
+ *
+ * @param pin_mask The pins to sample
+ * @return The levels of the pins in the mask, in their bit positions; the
+ *      other bits are 0
+ */
+static inline __attribute__((always_inline)) uint32_t read_input_pins(uint32_t pin_mask) {
+    return SIO->input & pin_mask;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+
+namespace pin_support {
+
+constexpr uint32_t mask_of() {
+    return 0;
+}
+
+template<typename... Rest>
+constexpr uint32_t mask_of(unsigned int pin, Rest... rest) {
+    return PIN_MASK(pin) | mask_of(rest...);
+}
+
+constexpr bool all_exist() {
+    return true;
+}
+
+template<typename... Rest>
+constexpr bool all_exist(unsigned int pin, Rest... rest) {
+    return pin < NUMBER_OF_GPIO_PINS && all_exist(rest...);
+}
+
+} // namespace pin_support
+
+/**
+ * A set of GPIO pins named at compile time.
+ */
+template<unsigned int... PINS>
+struct Pins {
+    static_assert(sizeof...(PINS) > 0, "name at least one pin");
+    static_assert(pin_support::all_exist(PINS...), "the RP2040 has GPIO pins 0-29");
+
+    static uint32_t constexpr mask = pin_support::mask_of(PINS...);
+
+    static void set() {
+        set_output_pins(mask);
+    }
+
+    static void clear() {
+        clear_output_pins(mask);
+    }
+
+    static void toggle() {
+        toggle_output_pins(mask);
+    }
+
+    // the pins' levels, in their bit positions
+    static uint32_t read() {
+        return read_input_pins(mask);
+    }
+
+    // whether any of the pins is high
+    static bool is_high() {
+        return read() != 0;
+    }
+};
+
+template<unsigned int PIN>
+using Pin = Pins<PIN>;
+
+#endif //__cplusplus
+
+#endif //COMBOLOCK_PINS_H
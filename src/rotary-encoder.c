@@ -18,12 +18,24 @@
 // clang-format off
 #include <CowPi.h>
 #include "interrupt_support.h"
+#include "pins.h"
 #include "rotary-encoder.h"
+#include "encoder-bank.h"
 #include "display.h"
+#include "input-activity.h"
+#include "format.h"
+#include "lock-config.h"
+#include "telemetry.h"
+#include "trace.h"
 // clang-format on
 
-#define A_WIPER_PIN (16)
-#define B_WIPER_PIN (A_WIPER_PIN + 1)
+// each lock's B wiper follows its A wiper
+#define WIPER_PINS_OF(lock) (PIN_MASK(LOCK_A_WIPER_PIN(lock)) | PIN_MASK(LOCK_A_WIPER_PIN(lock) + 1))
+
+// a hurried turn changes the wipers every few milliseconds, so a stall of tens of milliseconds fills only a few samples
+#define WIPER_SAMPLE_TIMER (1)
+#define WIPER_SAMPLE_PERIOD_uS (250)
+#define WIPER_SAMPLE_CAPACITY (32)
 
 typedef enum {
     HIGH_HIGH,
@@ -33,56 +45,107 @@ typedef enum {
     UNKNOWN
 } rotation_state_t;
 
-volatile cowpi_ioport_t *ioport = (cowpi_ioport_t *)(0xD0000000);
-static rotation_state_t volatile state;
-static direction_t volatile direction = STATIONARY;
+// one entry per lock; the ISR decodes every lock's wipers from a single load
+static rotation_state_t volatile state[NUMBER_OF_LOCKS];
+static rotation_state_t last_state[NUMBER_OF_LOCKS];
+static uint8_t last_quadrature[NUMBER_OF_LOCKS];
+static direction_t volatile direction[NUMBER_OF_LOCKS];
+static uint32_t wiper_pins = 0;
 static int volatile clockwise_count = 0;
 static int volatile counterclockwise_count = 0;
 
+/*
+ * While flash is stalled, the pin interrupt is blocked, and the flash-safe
+ * sampler records each change of the wipers here instead. A full buffer keeps
+ * the latest change in its last entry.
+ */
+static uint32_t volatile wiper_samples[WIPER_SAMPLE_CAPACITY];
+static uint8_t volatile number_of_wiper_samples = 0;
+static uint32_t volatile last_wiper_sample = 0;
+static bool is_sampler_registered = false;
+
 static void handle_quadrature_interrupt();
+static void sample_wipers();
 
-void initialize_rotary_encoder() {
-    cowpi_set_pullup_input_pins((1 << A_WIPER_PIN) | (1 << B_WIPER_PIN));
+#ifdef PIO_UNIT_TESTING
+// lets the on-target benchmarks call the ISR directly
+void (*const rotary_encoder_isr)(void) = handle_quadrature_interrupt;
+#endif
 
-    state = get_quadrature();
-    direction = STATIONARY;
+static inline uint8_t quadrature_of(uint8_t lock, uint32_t inputs) {
+    // the wipers are adjacent, so one shift gives B in bit 1 and A in bit 0
+    return (uint8_t) ((inputs >> LOCK_A_WIPER_PIN(lock)) & 0x3);
+}
+
+void initialize_rotary_encoder() {
+    wiper_pins = 0;
+    for (uint8_t lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        wiper_pins |= WIPER_PINS_OF(lock);
+    }
+    cowpi_set_pullup_input_pins(wiper_pins);
+
+    // get_quadrature() reports the wipers as bits, which are not numbered like rotation_state_t
+    static rotation_state_t const state_of_quadrature[] = {
+        [0b00] = LOW_LOW, [0b01] = LOW_HIGH, [0b10] = HIGH_LOW, [0b11] = HIGH_HIGH
+    };
+    uint32_t inputs = read_input_pins(wiper_pins);
+    for (uint8_t lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        last_quadrature[lock] = quadrature_of(lock, inputs);
+        state[lock] = state_of_quadrature[last_quadrature[lock]];
+        last_state[lock] = HIGH_HIGH;
+        direction[lock] = STATIONARY;
+    }
 
     clockwise_count = 0;
     counterclockwise_count = 0;
 
-    register_pin_ISR((1 << A_WIPER_PIN) | (1 << B_WIPER_PIN), handle_quadrature_interrupt);
+    register_pin_ISR(wiper_pins, handle_quadrature_interrupt);
+    // it runs only during flash stalls
+    is_sampler_registered = register_flash_safe_timer_ISR(WIPER_SAMPLE_TIMER, WIPER_SAMPLE_PERIOD_uS, sample_wipers);
+    set_flash_safe_timer_running(WIPER_SAMPLE_TIMER, false);
 }
 
 uint8_t get_quadrature() {
-    uint8_t A = (ioport->input >> A_WIPER_PIN) & 0x1;
-    uint8_t B = (ioport->input >> B_WIPER_PIN) & 0x1;
-    return (B << 1) | (A << 0);
+    return quadrature_of(0, read_input_pins(WIPER_PINS_OF(0)));
 }
 
 char *count_rotations(char *buffer) {
-    sprintf(buffer, "CW:%2d CCW:%2d", clockwise_count, counterclockwise_count);
+    FORMAT(buffer, "CW:", decimal_field(clockwise_count, 2), " CCW:", decimal_field(counterclockwise_count, 2));
     return buffer;
 }
 
 direction_t get_direction() {
-    direction_t direction_copy = direction;
-    direction = STATIONARY;
+    return get_direction_of(0);
+}
+
+direction_t get_direction_of(uint8_t lock) {
+    direction_t direction_copy = direction[lock];
+    direction[lock] = STATIONARY;
     return direction_copy;
 }
 
-static void handle_quadrature_interrupt() {
-    static rotation_state_t last_state = HIGH_HIGH;
-    uint8_t quadrature = get_quadrature();
-    rotation_state_t next_state = state;
+static inline void report_detent(uint8_t lock, direction_t turned) {
+    // a detent that the controller has not read yet is about to be overwritten
+    if (direction[lock] != STATIONARY) {
+        telemetry_count(TELEMETRY_DROPPED_DETENTS);
+    }
+    direction[lock] = turned;
+    telemetry_tag_input_from_isr();
+    trace_record(TRACE_DETENT, (lock << 2) | turned);
+}
+
+static void decode_quadrature(uint8_t lock, uint8_t quadrature) {
+    rotation_state_t next_state = state[lock];
+    trace_record(TRACE_QUADRATURE, (lock << 2) | quadrature);
 
     switch (quadrature) {
         case 0b00:
-            if (state == HIGH_LOW && last_state == HIGH_HIGH) {
+            if (state[lock] == HIGH_LOW && last_state[lock] == HIGH_HIGH) {
                 clockwise_count++;
-                direction = CLOCKWISE;
-            } else if (state == LOW_HIGH && last_state == HIGH_HIGH) {
+                report_detent(lock, CLOCKWISE);
+            } else if (state[lock] == LOW_HIGH && last_state[lock] == HIGH_HIGH) {
                 counterclockwise_count++;
-                direction = COUNTERCLOCKWISE;
+                report_detent(lock, COUNTERCLOCKWISE);
             }
             next_state = LOW_LOW;
             break;
@@ -100,6 +163,69 @@ static void handle_quadrature_interrupt() {
             break;
     }
 
-    last_state = state; 
-    state = next_state;
-}
\ No newline at end of file
+    last_state[lock] = state[lock];
+    state[lock] = next_state;
+}
+
+static void decode_wipers(uint32_t inputs) {
+    for (uint8_t lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        uint8_t quadrature = quadrature_of(lock, inputs);
+        // the interrupt may have come from another lock's encoder, whose wipers this one must not re-decode
+        if (NUMBER_OF_LOCKS == 1 || quadrature != last_quadrature[lock]) {
+            last_quadrature[lock] = quadrature;
+            decode_quadrature(lock, quadrature);
+        }
+    }
+}
+
+static void handle_quadrature_interrupt() {
+    uint32_t inputs = read_input_pins(wiper_pins);
+    telemetry_count(TELEMETRY_QUADRATURE_INTERRUPTS);
+    note_input_activity();
+    decode_wipers(inputs);
+}
+
+static void FLASH_SAFE_ISR(sample_wipers)() {
+    uint32_t inputs = read_input_pins(wiper_pins);
+    if (inputs != last_wiper_sample) {
+        uint8_t position = number_of_wiper_samples;
+        if (position < WIPER_SAMPLE_CAPACITY) {
+            number_of_wiper_samples = (uint8_t) (position + 1);
+        } else {
+            position = WIPER_SAMPLE_CAPACITY - 1;
+        }
+        wiper_samples[position] = inputs;
+        last_wiper_sample = inputs;
+    }
+}
+
+void begin_sampling_wipers() {
+    if (!is_sampler_registered) {
+        return;
+    }
+    // the sampler compares against what the decoder has seen, so an edge still pending is sampled too
+    uint32_t decoded = 0;
+    for (uint8_t lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        decoded |= (uint32_t) last_quadrature[lock] << LOCK_A_WIPER_PIN(lock);
+    }
+    last_wiper_sample = decoded;
+    number_of_wiper_samples = 0;
+    set_flash_safe_timer_running(WIPER_SAMPLE_TIMER, true);
+}
+
+void finish_sampling_wipers() {
+    if (!is_sampler_registered) {
+        return;
+    }
+    set_flash_safe_timer_running(WIPER_SAMPLE_TIMER, false);
+    // discard the latched edges before the last sample, so that an edge after it still interrupts
+    discard_pending_pin_interrupts(wiper_pins);
+    sample_wipers();
+    if (number_of_wiper_samples > 0) {
+        note_input_activity();
+    }
+    for (uint8_t i = 0; i < number_of_wiper_samples; i++) {
+        decode_wipers(wiper_samples[i]);
+    }
+    number_of_wiper_samples = 0;
+}
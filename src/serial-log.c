@@ -0,0 +1,173 @@
+/**************************************************************************/
+/**
+ *
+ * @file serial-log.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief serial-log.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "serial-log.h"
+#include "telemetry.h"
+
+_Static_assert((SERIAL_LOG_CAPACITY & (SERIAL_LOG_CAPACITY - 1)) == 0,
+               "SERIAL_LOG_CAPACITY must be a power of two");
+_Static_assert((SERIAL_LOG_MAXIMUM_RECORDS & (SERIAL_LOG_MAXIMUM_RECORDS - 1)) == 0,
+               "SERIAL_LOG_MAXIMUM_RECORDS must be a power of two");
+
+/*
+ * Positions count bytes without wrapping at the capacity; only their
+ * differences matter, and the low bits index the buffer. In order:
+ *   read_position       the next byte to send
+ *   committed_position  the end of the last finished record
+ *   write_position      the end of the record being built
+ * first_record_start is where the oldest queued record begins; it lies behind
+ * read_position once that record has started to go out.
+ */
+static uint8_t buffer[SERIAL_LOG_CAPACITY];
+static uint32_t read_position = 0;
+static uint32_t committed_position = 0;
+static uint32_t write_position = 0;
+static uint32_t first_record_start = 0;
+
+// the end positions of the queued records, oldest first
+static uint32_t record_ends[SERIAL_LOG_MAXIMUM_RECORDS];
+static uint16_t first_record = 0;
+static uint16_t next_record = 0;
+
+static serial_log_policy_t policy = SERIAL_LOG_DROP_OLDEST;
+static bool is_building = false;
+static bool is_dropping = false;
+static size_t open_record_length = 0;
+
+void set_serial_log_policy(serial_log_policy_t new_policy) {
+    policy = new_policy;
+}
+
+void clear_serial_log(void) {
+    read_position = committed_position;
+    write_position = committed_position;
+    first_record_start = committed_position;
+    first_record = next_record;
+    is_building = false;
+}
+
+static uint16_t number_of_records(void) {
+    return (uint16_t) (next_record - first_record);
+}
+
+static bool drop_oldest_record(void) {
+    // a record that has started to go out has to finish, or the port would carry half of it
+    if (number_of_records() == 0 || read_position != first_record_start) {
+        return false;
+    }
+    uint32_t end = record_ends[first_record & (SERIAL_LOG_MAXIMUM_RECORDS - 1)];
+    telemetry_count(TELEMETRY_DROPPED_LOG_RECORDS);
+    telemetry_count_many(TELEMETRY_DROPPED_LOG_BYTES, end - first_record_start);
+    read_position = end;
+    first_record_start = end;
+    first_record++;
+    return true;
+}
+
+static bool make_room(size_t length) {
+    while (SERIAL_LOG_CAPACITY - (write_position - read_position) < length) {
+        if (policy != SERIAL_LOG_DROP_OLDEST || !drop_oldest_record()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void serial_log_begin(void) {
+    write_position = committed_position;
+    is_building = true;
+    is_dropping = false;
+    open_record_length = 0;
+}
+
+void serial_log_append(void const *data, size_t length) {
+    if (!is_building) {
+        return;
+    }
+    open_record_length += length;
+    if (is_dropping) {
+        return;
+    }
+    if (!make_room(length)) {
+        is_dropping = true;
+        write_position = committed_position;
+        return;
+    }
+    uint32_t offset = write_position & (SERIAL_LOG_CAPACITY - 1);
+    size_t first_part = (length < SERIAL_LOG_CAPACITY - offset) ? length : SERIAL_LOG_CAPACITY - offset;
+    memcpy(buffer + offset, data, first_part);
+    memcpy(buffer, (uint8_t const *) data + first_part, length - first_part);
+    write_position += (uint32_t) length;
+}
+
+void serial_log_print(char const *string) {
+    serial_log_append(string, strlen(string));
+}
+
+bool serial_log_end(void) {
+    if (!is_building) {
+        return false;
+    }
+    is_building = false;
+    while (!is_dropping && number_of_records() == SERIAL_LOG_MAXIMUM_RECORDS) {
+        if (policy != SERIAL_LOG_DROP_OLDEST || !drop_oldest_record()) {
+            is_dropping = true;
+        }
+    }
+    if (is_dropping) {
+        write_position = committed_position;
+        telemetry_count(TELEMETRY_DROPPED_LOG_RECORDS);
+        telemetry_count_many(TELEMETRY_DROPPED_LOG_BYTES, (uint32_t) open_record_length);
+        return false;
+    }
+    record_ends[next_record & (SERIAL_LOG_MAXIMUM_RECORDS - 1)] = write_position;
+    next_record++;
+    committed_position = write_position;
+    return true;
+}
+
+bool serial_log_line(char const *line) {
+    serial_log_begin();
+    serial_log_print(line);
+    serial_log_print("\r\n");
+    return serial_log_end();
+}
+
+size_t serial_log_room(void) {
+    if (number_of_records() == SERIAL_LOG_MAXIMUM_RECORDS) {
+        return 0;
+    }
+    return SERIAL_LOG_CAPACITY - (committed_position - read_position);
+}
+
+size_t serial_log_peek(void const **data) {
+    uint32_t offset = read_position & (SERIAL_LOG_CAPACITY - 1);
+    uint32_t queued = committed_position - read_position;
+    *data = buffer + offset;
+    return (queued < SERIAL_LOG_CAPACITY - offset) ? queued : SERIAL_LOG_CAPACITY - offset;
+}
+
+void serial_log_consume(size_t length) {
+    read_position += (uint32_t) length;
+    while (number_of_records() > 0
+           && (int32_t) (read_position - record_ends[first_record & (SERIAL_LOG_MAXIMUM_RECORDS - 1)]) >= 0) {
+        first_record_start = record_ends[first_record & (SERIAL_LOG_MAXIMUM_RECORDS - 1)];
+        first_record++;
+    }
+}
@@ -0,0 +1,131 @@
+/**************************************************************************/
+/**
+ *
+ * @file serial-log.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief A ring buffer that holds output for the Serial port until
+ *      <code>service_diagnostics()</code> can send it without blocking.
+ *
+ * Output is queued as records: a line of text, or a whole binary frame. A
+ * record is built with <code>serial_log_begin()</code>, any number of
+ * <code>serial_log_append()</code> or <code>serial_log_print()</code> calls,
+ * and <code>serial_log_end()</code>; it becomes visible to the drain only when
+ * it ends, and it is kept or dropped whole, so the port never carries half a
+ * line or half a frame.
+ *
+ * When a record does not fit, the policy decides what is lost. Under
+ * <code>SERIAL_LOG_DROP_NEWEST</code> the new record is dropped. Under
+ * <code>SERIAL_LOG_DROP_OLDEST</code> the oldest records are dropped to make
+ * room, but only while the oldest has not started to go out, since the
+ * records behind it cannot be removed from the middle of the buffer; if that
+ * does not make enough room, the new record is dropped. Dropped records and
+ * their bytes are counted as <code>TELEMETRY_DROPPED_LOG_RECORDS</code> and
+ * <code>TELEMETRY_DROPPED_LOG_BYTES</code>.
+ *
+ * The log is meant for <code>loop()</code>; it must not be written from an
+ * ISR.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_SERIAL_LOG_H
+#define COMBOLOCK_SERIAL_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SERIAL_LOG_CAPACITY (8192)          // bytes; a power of two, with room for a full trace frame
+#define SERIAL_LOG_MAXIMUM_RECORDS (128)    // a power of two
+
+typedef enum {
+    SERIAL_LOG_DROP_OLDEST,
+    SERIAL_LOG_DROP_NEWEST
+} serial_log_policy_t;
+
+/**
+ * Chooses what is lost when a record does not fit. The default is
+ * <code>SERIAL_LOG_DROP_OLDEST</code>.
+ */
+void set_serial_log_policy(serial_log_policy_t policy);
+
+/**
+ * Empties the log. A record that was being built is abandoned.
+ */
+void clear_serial_log(void);
+
+/**
+ * Starts a record. A record that was already being built is abandoned.
+ */
+void serial_log_begin(void);
+
+/**
+ * Adds bytes to the record being built.
+ *
+ * @param data The bytes
+ * @param length The number of bytes
+ */
+void serial_log_append(void const *data, size_t length);
+
+/**
+ * Adds a string, without its NUL, to the record being built.
+ *
+ * @param string The string
+ */
+void serial_log_print(char const *string);
+
+/**
+ * Finishes the record being built, making it available to the drain.
+ *
+ * @return <code>true</code> if the record was queued; <code>false</code> if it
+ *      was dropped
+ */
+bool serial_log_end(void);
+
+/**
+ * Queues a string as one line, followed by a carriage return and a newline.
+ *
+ * @param line The string
+ * @return <code>true</code> if the line was queued; <code>false</code> if it
+ *      was dropped
+ */
+bool serial_log_line(char const *line);
+
+/**
+ * @return The number of bytes that a new record can hold without dropping a
+ *      queued record, or 0 if no record can be queued without dropping one
+ */
+size_t serial_log_room(void);
+
+/**
+ * Finds the queued bytes that can be sent next.
+ *
+ * @param data Receives the address of the first byte
+ * @return The number of contiguous bytes at that address, which may be fewer
+ *      than are queued when the queue wraps around the end of the buffer
+ */
+size_t serial_log_peek(void const **data);
+
+/**
+ * Removes bytes that have been sent from the front of the log.
+ *
+ * @param length The number of bytes sent, no more than
+ *      <code>serial_log_peek()</code> reported
+ */
+void serial_log_consume(size_t length);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_SERIAL_LOG_H
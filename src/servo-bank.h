@@ -0,0 +1,51 @@
+/**************************************************************************/
+/**
+ *
+ * @file servo-bank.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief What the servo code makes available beyond the starter
+ *      servomotor.h: positioning each lock's servo on its own, and a look at
+ *      the servo signal for code that must not land on one of its edges.
+ *
+ * The starter functions move every servo in the bank together.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_SERVO_BANK_H
+#define COMBOLOCK_SERVO_BANK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void center_servo_of(uint8_t lock);
+void rotate_full_clockwise_of(uint8_t lock);
+void rotate_full_counterclockwise_of(uint8_t lock);
+
+/**
+ * Reports, without waiting, whether every servo signal is low and will stay
+ * low for at least the given time, as of the servo ISR's last tick.
+ *
+ * @param duration_us How long the signals must stay low; longer than the
+ *      longest gap in the signal is taken as the longest gap
+ * @return <code>true</code> if the signals are in a long enough gap, or if
+ *      the servo is not running; <code>false</code> otherwise
+ */
+bool servo_is_quiet_for(int duration_us);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_SERVO_BANK_H
@@ -18,70 +18,139 @@
 // clang-format off
 #include <CowPi.h>
 #include "servomotor.h"
+#include "servo-bank.h"
+#include "format.h"
 #include "interrupt_support.h"
+#include "lock-config.h"
+#include "pins.h"
+#include "telemetry.h"
 // clang-format on
 
-#define SERVO_PIN (22)
 #define PULSE_INCREMENT_uS (100)
 #define SIGNAL_PERIOD_uS (20000)
+#define LONGEST_QUIET_PERIOD_uS (SIGNAL_PERIOD_uS - 2500 - 2 * PULSE_INCREMENT_uS)
+#define SERVO_TIMER (0)
 
-static volatile int pulse_width_us;
-static volatile cowpi_ioport_t *ioport = (cowpi_ioport_t *)(0xD0000000);
+// one entry per lock; every servo's pulse rises on the same tick, and each falls on its own
+static volatile int pulse_width_us[NUMBER_OF_LOCKS];
+static volatile int time_to_fall[NUMBER_OF_LOCKS];
+static uint32_t servo_pins = 0;
+static volatile int time_to_rise = 0;
+static volatile int time_to_last_fall = 0;
+// how long the signals will stay low, as of the last tick; 0 while any pulse is high
+static volatile int quiet_for_us = 0;
+static volatile bool is_running = false;
 
 static void handle_timer_interrupt();
 
+#ifdef PIO_UNIT_TESTING
+// lets the on-target benchmarks call the ISR directly
+void (*const servo_timer_isr)(void) = handle_timer_interrupt;
+#endif
+
 void initialize_servo() {
-    cowpi_set_output_pins(1u << SERVO_PIN);
-    center_servo();
-    register_periodic_timer_ISR(0, PULSE_INCREMENT_uS, handle_timer_interrupt);
+    servo_pins = 0;
+    for (uint8_t lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        servo_pins |= PIN_MASK(LOCK_SERVO_PIN(lock));
+        time_to_fall[lock] = 0;
+        center_servo_of(lock);
+    }
+    cowpi_set_output_pins(servo_pins);
+    // the edges must not wait behind a quadrature decode or anything else, nor stop while flash is written
+    register_flash_safe_timer_ISR(SERVO_TIMER, PULSE_INCREMENT_uS, handle_timer_interrupt);
+    is_running = true;
 }
 
 char *test_servo(char *buffer) {
+    // every servo in the bank follows the same test
     // Requirement 2: center on left button press
     if (cowpi_left_button_is_pressed()) {
         center_servo();
-        sprintf(buffer, "SERVO: center");
+        FORMAT(buffer, "SERVO: center");
     }
     // Requirement 3a: if button not pressed and left switch is left -> full CW
     else if (cowpi_left_switch_is_in_left_position()) {
         rotate_full_clockwise();
-        sprintf(buffer, "SERVO: left");
+        FORMAT(buffer, "SERVO: left");
     }
     // Requirement 3b: if button not pressed and left switch is right -> full CCW
     else {
         rotate_full_counterclockwise();
-        sprintf(buffer, "SERVO: right");
+        FORMAT(buffer, "SERVO: right");
     }
     return buffer;
 }
 
+static void set_every_pulse_width(int width_us) {
+    for (uint8_t lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        pulse_width_us[lock] = width_us;
+    }
+}
+
 void center_servo() {
-    pulse_width_us = 1500;
+    set_every_pulse_width(1500);
 }
 
 void rotate_full_clockwise() {
-    pulse_width_us = 2500;
+    set_every_pulse_width(2500);
 }
 
 void rotate_full_counterclockwise() {
-    pulse_width_us = 500;
+    set_every_pulse_width(500);
+}
+
+void center_servo_of(uint8_t lock) {
+    pulse_width_us[lock] = 1500;
+}
+
+void rotate_full_clockwise_of(uint8_t lock) {
+    pulse_width_us[lock] = 2500;
+}
+
+void rotate_full_counterclockwise_of(uint8_t lock) {
+    pulse_width_us[lock] = 500;
 }
 
-static void handle_timer_interrupt() {
-    static int time_to_rise = 0;
-    static int time_to_fall = 0;
+bool servo_is_quiet_for(int duration_us) {
+    if (!is_running) {
+        return true;
+    }
+    // the signals are low from the last falling edge until the next rising edge, which is never longer than this
+    if (duration_us > LONGEST_QUIET_PERIOD_uS) {
+        duration_us = LONGEST_QUIET_PERIOD_uS;
+    }
+    // one word, written only by the ISR, so it cannot be read half-updated
+    return quiet_for_us >= duration_us;
+}
 
+// runs from RAM, and so calls only inline functions
+static void FLASH_SAFE_ISR(handle_timer_interrupt)() {
+    telemetry_count(TELEMETRY_SERVO_INTERRUPTS);
     if (time_to_rise <= 0) {
-        // start pulse
-        ioport->output |= (1u << SERVO_PIN);
+        // start pulses
+        set_output_pins(servo_pins);
         time_to_rise += SIGNAL_PERIOD_uS;
-        time_to_fall = pulse_width_us;
+        time_to_last_fall = 0;
+        for (uint8_t lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+            time_to_fall[lock] = pulse_width_us[lock];
+            if (time_to_fall[lock] > time_to_last_fall) {
+                time_to_last_fall = time_to_fall[lock];
+            }
+        }
     }
-    if (time_to_fall <= 0) {
-        // end pulse
-        ioport->output &= ~(1u << SERVO_PIN);
+    // end pulses, all in one store
+    uint32_t falling_pins = 0;
+    for (uint8_t lock = 0; lock < NUMBER_OF_LOCKS; lock++) {
+        if (time_to_fall[lock] <= 0) {
+            falling_pins |= PIN_MASK(LOCK_SERVO_PIN(lock));
+        }
+        time_to_fall[lock] -= PULSE_INCREMENT_uS;
+    }
+    if (falling_pins) {
+        clear_output_pins(falling_pins);
     }
 
     time_to_rise -= PULSE_INCREMENT_uS;
-    time_to_fall -= PULSE_INCREMENT_uS;
-}
\ No newline at end of file
+    time_to_last_fall -= PULSE_INCREMENT_uS;
+    quiet_for_us = (time_to_last_fall < 0) ? time_to_rise : 0;
+}
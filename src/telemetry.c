@@ -0,0 +1,213 @@
+/**************************************************************************/
+/**
+ *
+ * @file telemetry.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief telemetry.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+// clang-format off
+#include <CowPi.h>
+#include <hardware/sync.h>
+#include "interrupt_support.h"
+#include "memory-map.h"
+#include "telemetry.h"
+// clang-format on
+
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *)(TIMER_BASE_ADDRESS);
+volatile uint32_t telemetry_counters[NUMBER_OF_TELEMETRY_COUNTERS];
+static struct telemetry_phase phases[NUMBER_OF_TELEMETRY_PHASES];
+static uint32_t window_start_us = 0;
+static uint32_t previous_loop_us = 0;
+static bool has_previous_loop = false;
+static struct telemetry_boot_mark boot_marks[NUMBER_OF_TELEMETRY_BOOT_PHASES];
+static uint32_t previous_boot_mark_us = 0;     // the timer starts from 0 at reset
+
+static char const *const phase_names[NUMBER_OF_TELEMETRY_PHASES] = {
+    [TELEMETRY_LOOP] = "loop",
+    [TELEMETRY_CONTROL_LOCK] = "control_lock",
+    [TELEMETRY_DISPLAY_FORMAT] = "display_format",
+    [TELEMETRY_DISPLAY_FLUSH] = "display_flush",
+    [TELEMETRY_INPUT_TO_PIXEL] = "input_to_pixel",
+    [TELEMETRY_CLOCK_SWITCH] = "clock_switch",
+};
+
+static char const *const counter_names[NUMBER_OF_TELEMETRY_COUNTERS] = {
+    [TELEMETRY_QUADRATURE_INTERRUPTS] = "quadrature_interrupts",
+    [TELEMETRY_SERVO_INTERRUPTS] = "servo_interrupts",
+    [TELEMETRY_KEYPAD_INTERRUPTS] = "keypad_interrupts",
+    [TELEMETRY_DROPPED_DETENTS] = "dropped_detents",
+    [TELEMETRY_DROPPED_KEY_EVENTS] = "dropped_key_events",
+    [TELEMETRY_DROPPED_LOG_RECORDS] = "dropped_log_records",
+    [TELEMETRY_DROPPED_LOG_BYTES] = "dropped_log_bytes",
+};
+
+static char const *const boot_phase_names[NUMBER_OF_TELEMETRY_BOOT_PHASES] = {
+    [TELEMETRY_BOOT_COWPI_SETUP] = "cowpi_setup",
+    [TELEMETRY_BOOT_CLOCK_GOVERNOR] = "clock_governor",
+    [TELEMETRY_BOOT_DISPLAY] = "display",
+    [TELEMETRY_BOOT_ROTARY_ENCODER] = "rotary_encoder",
+    [TELEMETRY_BOOT_SERVO] = "servo",
+    [TELEMETRY_BOOT_KEYPAD] = "keypad",
+    [TELEMETRY_BOOT_LOCK_CONTROLLER] = "lock_controller",
+    [TELEMETRY_BOOT_READY] = "ready",
+    [TELEMETRY_BOOT_FIRST_FRAME] = "first_frame",
+    [TELEMETRY_BOOT_BUILD_TIMESTAMPS] = "build_timestamps",
+};
+
+#if TELEMETRY_ENABLED
+
+static void record_duration(telemetry_phase_t phase, uint32_t duration_us) {
+    struct telemetry_phase *statistics = &phases[phase];
+    int bucket = (duration_us == 0) ? 0 : 32 - __builtin_clz(duration_us);
+    if (bucket >= TELEMETRY_HISTOGRAM_BUCKETS) {
+        bucket = TELEMETRY_HISTOGRAM_BUCKETS - 1;
+    }
+    statistics->histogram[bucket]++;
+    statistics->count++;
+    statistics->total_us += duration_us;
+    if (duration_us > statistics->maximum_us) {
+        statistics->maximum_us = duration_us;
+    }
+}
+
+uint32_t telemetry_start(void) {
+    return timer->raw_lower_word;
+}
+
+void telemetry_finish(telemetry_phase_t phase, uint32_t start_us) {
+    record_duration(phase, timer->raw_lower_word - start_us);
+}
+
+void telemetry_mark_loop(void) {
+    uint32_t now = timer->raw_lower_word;
+    if (has_previous_loop) {
+        record_duration(TELEMETRY_LOOP, now - previous_loop_us);
+    }
+    previous_loop_us = now;
+    has_previous_loop = true;
+}
+
+void telemetry_mark_boot(telemetry_boot_phase_t phase) {
+    uint32_t now = timer->raw_lower_word;
+    if (phase < NUMBER_OF_TELEMETRY_BOOT_PHASES && !boot_marks[phase].is_set) {
+        boot_marks[phase].at_us = now;
+        boot_marks[phase].duration_us = now - previous_boot_mark_us;
+        boot_marks[phase].is_set = true;
+        previous_boot_mark_us = now;
+    }
+}
+
+#endif //TELEMETRY_ENABLED
+
+#if TELEMETRY_ENABLED && LATENCY_PROBE
+
+/*
+ * Each stage holds the time of the oldest input that has reached it: tagged
+ * but not yet claimed by a step, claimed by the step in progress, or written
+ * into a frame that has not been flushed yet.
+ */
+struct input_tag {
+    uint32_t timestamp_us;
+    bool is_set;
+};
+
+static volatile struct input_tag pending_tag;
+static struct input_tag step_tag;
+static struct input_tag frame_tag;
+
+static void keep_oldest(struct input_tag *tag, uint32_t timestamp_us) {
+    if (!tag->is_set || (int32_t) (timestamp_us - tag->timestamp_us) < 0) {
+        tag->timestamp_us = timestamp_us;
+        tag->is_set = true;
+    }
+}
+
+void telemetry_tag_input_from_isr(void) {
+    if (!pending_tag.is_set) {
+        pending_tag.timestamp_us = timer->raw_lower_word;
+        pending_tag.is_set = true;
+    }
+}
+
+void telemetry_tag_queued_input(uint32_t detected_us) {
+    keep_oldest(&step_tag, detected_us);
+}
+
+void telemetry_begin_step(void) {
+    // only the quadrature ISR tags inputs; the servo's ISR may keep running
+    critical_section_t section = begin_critical_section(ISR_PRIORITY_NORMAL);
+    step_tag.timestamp_us = pending_tag.timestamp_us;
+    step_tag.is_set = pending_tag.is_set;
+    pending_tag.is_set = false;
+    end_critical_section(section);
+}
+
+void telemetry_end_step(void) {
+    // an input whose step wrote nothing to the display has no pixels to wait for
+    step_tag.is_set = false;
+}
+
+void telemetry_note_display_change(void) {
+    if (step_tag.is_set) {
+        keep_oldest(&frame_tag, step_tag.timestamp_us);
+    }
+}
+
+void telemetry_note_frame_shown(void) {
+    if (frame_tag.is_set) {
+        record_duration(TELEMETRY_INPUT_TO_PIXEL, timer->raw_lower_word - frame_tag.timestamp_us);
+        frame_tag.is_set = false;
+    }
+}
+
+#endif //TELEMETRY_ENABLED && LATENCY_PROBE
+
+void telemetry_take_snapshot(struct telemetry_snapshot *snapshot) {
+    snapshot->window_us = timer->raw_lower_word - window_start_us;
+    for (int i = 0; i < NUMBER_OF_TELEMETRY_COUNTERS; i++) {
+        snapshot->counters[i] = telemetry_counters[i];
+    }
+    memcpy(snapshot->phases, phases, sizeof(phases));
+}
+
+void telemetry_clear(void) {
+    memset(phases, 0, sizeof(phases));
+    uint32_t interrupt_status = save_and_disable_interrupts();
+    for (int i = 0; i < NUMBER_OF_TELEMETRY_COUNTERS; i++) {
+        telemetry_counters[i] = 0;
+    }
+    restore_interrupts(interrupt_status);
+    window_start_us = timer->raw_lower_word;
+    // the pass that cleared the statistics should not count against the next window
+    has_previous_loop = false;
+}
+
+bool telemetry_get_boot_mark(telemetry_boot_phase_t phase, struct telemetry_boot_mark *mark) {
+    if (phase >= NUMBER_OF_TELEMETRY_BOOT_PHASES) {
+        return false;
+    }
+    *mark = boot_marks[phase];
+    return mark->is_set;
+}
+
+char const *telemetry_phase_name(telemetry_phase_t phase) {
+    return (phase < NUMBER_OF_TELEMETRY_PHASES) ? phase_names[phase] : "";
+}
+
+char const *telemetry_counter_name(telemetry_counter_t counter) {
+    return (counter < NUMBER_OF_TELEMETRY_COUNTERS) ? counter_names[counter] : "";
+}
+
+char const *telemetry_boot_phase_name(telemetry_boot_phase_t phase) {
+    return (phase < NUMBER_OF_TELEMETRY_BOOT_PHASES) ? boot_phase_names[phase] : "";
+}
@@ -0,0 +1,261 @@
+/**************************************************************************/
+/**
+ *
+ * @file telemetry.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Counters and latency histograms for the main loop, the lock
+ *      controller, and the display, read out over Serial rather than shown.
+ *
+ * Each phase keeps a count, a total, a maximum, and a histogram of its
+ * durations in power-of-two buckets: bucket 0 counts durations of 0 µs, and
+ * bucket <i>b</i> counts durations from 2<sup><i>b</i>-1</sup> µs up to
+ * 2<sup><i>b</i></sup> µs, except that the last bucket also counts anything
+ * longer. Phases are recorded from <code>loop()</code>'s context; counters
+ * may be incremented from ISRs.
+ *
+ * Recording can be compiled out with <code>-D TELEMETRY_ENABLED=0</code>.
+ *
+ * Building with <code>-D LATENCY_PROBE=1</code> also measures the latency from
+ * a physical input to the frame that shows its effect. Each detent is tagged
+ * with the time its ISR ran, and each keypress with the time the keypad scan
+ * first saw it.
+ * The controller step that consumes the input carries the tag; if that step
+ * writes to the display, the tag rides on the frame until
+ * <code>refresh_display()</code> has flushed it to the panel, and the elapsed
+ * time is recorded as <code>TELEMETRY_INPUT_TO_PIXEL</code>. An input that
+ * changes nothing on the display is not counted. If several inputs reach the
+ * same frame, the oldest one is measured.
+ *
+ * Boot is profiled separately: <code>setup()</code> and the first pass of
+ * <code>loop()</code> mark the end of each boot phase, and each mark keeps the
+ * time since reset and the time since the previous mark. Clearing the
+ * statistics does not clear the boot marks. Building with
+ * <code>-D FAST_BOOT=1</code> shortens the boot that this profiles.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_TELEMETRY_H
+#define COMBOLOCK_TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TELEMETRY_ENABLED
+#define TELEMETRY_ENABLED (1)
+#endif
+
+#ifndef LATENCY_PROBE
+#define LATENCY_PROBE (0)
+#endif
+
+#ifndef FAST_BOOT
+#define FAST_BOOT (0)               // 1 defers work that boot does not need until the lock is ready
+#endif
+
+#define TELEMETRY_HISTOGRAM_BUCKETS (16)
+
+typedef enum {
+    TELEMETRY_LOOP,                 // from one pass of loop() to the next
+    TELEMETRY_CONTROL_LOCK,         // one call to control_lock()
+    TELEMETRY_DISPLAY_FORMAT,       // drawing the rows into the frame buffer
+    TELEMETRY_DISPLAY_FLUSH,        // sending the frame buffer over I2C
+    TELEMETRY_INPUT_TO_PIXEL,       // from a detent or keypress to the frame showing it (LATENCY_PROBE only)
+    TELEMETRY_CLOCK_SWITCH,         // one change of the system clock, which the pass that makes it must absorb
+    NUMBER_OF_TELEMETRY_PHASES
+} telemetry_phase_t;
+
+typedef enum {
+    TELEMETRY_QUADRATURE_INTERRUPTS,
+    TELEMETRY_SERVO_INTERRUPTS,
+    TELEMETRY_KEYPAD_INTERRUPTS,
+    TELEMETRY_DROPPED_DETENTS,      // detents overwritten before the controller read them
+    TELEMETRY_DROPPED_KEY_EVENTS,   // key events that found the keypad's queue full
+    TELEMETRY_DROPPED_LOG_RECORDS,  // lines and frames dropped from the serial log
+    TELEMETRY_DROPPED_LOG_BYTES,
+    NUMBER_OF_TELEMETRY_COUNTERS
+} telemetry_counter_t;
+
+typedef enum {
+    TELEMETRY_BOOT_COWPI_SETUP,
+    TELEMETRY_BOOT_CLOCK_GOVERNOR,
+    TELEMETRY_BOOT_DISPLAY,
+    TELEMETRY_BOOT_ROTARY_ENCODER,
+    TELEMETRY_BOOT_SERVO,
+    TELEMETRY_BOOT_KEYPAD,
+    TELEMETRY_BOOT_LOCK_CONTROLLER,
+    TELEMETRY_BOOT_READY,           // the first pass of loop() begins, and the lock responds to input
+    TELEMETRY_BOOT_FIRST_FRAME,     // the first pass of loop() has refreshed the display
+    TELEMETRY_BOOT_BUILD_TIMESTAMPS,
+    NUMBER_OF_TELEMETRY_BOOT_PHASES
+} telemetry_boot_phase_t;
+
+struct telemetry_phase {
+    uint32_t count;
+    uint32_t maximum_us;
+    uint64_t total_us;
+    uint32_t histogram[TELEMETRY_HISTOGRAM_BUCKETS];
+};
+
+struct telemetry_boot_mark {
+    uint32_t at_us;                 // since reset
+    uint32_t duration_us;           // since the previous mark, whichever phase that was
+    bool is_set;
+};
+
+struct telemetry_snapshot {
+    uint32_t window_us;             // time since the statistics were last cleared
+    uint32_t counters[NUMBER_OF_TELEMETRY_COUNTERS];
+    struct telemetry_phase phases[NUMBER_OF_TELEMETRY_PHASES];
+};
+
+#if TELEMETRY_ENABLED
+
+/**
+ * Marks the start of a phase.
+ *
+ * @return The start time, to be passed to <code>telemetry_finish()</code>
+ */
+uint32_t telemetry_start(void);
+
+/**
+ * Records the duration of a phase that began at <code>start_us</code>.
+ *
+ * @param phase The phase that just finished
+ * @param start_us The value that <code>telemetry_start()</code> returned
+ */
+void telemetry_finish(telemetry_phase_t phase, uint32_t start_us);
+
+/**
+ * Marks one pass of <code>loop()</code>, recording the time since the
+ * previous mark as a <code>TELEMETRY_LOOP</code> duration.
+ */
+void telemetry_mark_loop(void);
+
+/**
+ * Marks the end of a boot phase. Only the first mark of each phase is kept.
+ */
+void telemetry_mark_boot(telemetry_boot_phase_t phase);
+
+extern volatile uint32_t telemetry_counters[NUMBER_OF_TELEMETRY_COUNTERS];
+
+/**
+ * Increments a counter. Safe to call from an ISR that is the only writer of
+ * that counter, including a flash-safe ISR.
+ */
+static inline __attribute__((always_inline)) void telemetry_count(telemetry_counter_t counter) {
+    telemetry_counters[counter] = telemetry_counters[counter] + 1;
+}
+
+/**
+ * Adds to a counter, under the same condition as <code>telemetry_count()</code>.
+ */
+static inline void telemetry_count_many(telemetry_counter_t counter, uint32_t amount) {
+    telemetry_counters[counter] = telemetry_counters[counter] + amount;
+}
+
+#else
+
+static inline uint32_t telemetry_start(void) { return 0; }
+static inline void telemetry_finish(telemetry_phase_t phase, uint32_t start_us) {}
+static inline void telemetry_mark_loop(void) {}
+static inline void telemetry_mark_boot(telemetry_boot_phase_t phase) {}
+static inline void telemetry_count(telemetry_counter_t counter) {}
+static inline void telemetry_count_many(telemetry_counter_t counter, uint32_t amount) {}
+
+#endif //TELEMETRY_ENABLED
+
+#if TELEMETRY_ENABLED && LATENCY_PROBE
+
+/**
+ * Tags an input detected by an ISR, for the next controller step to claim.
+ */
+void telemetry_tag_input_from_isr(void);
+
+/**
+ * Tags an input that the current controller step has just taken from a queue.
+ *
+ * @param detected_us When the input was detected, on the microsecond timer
+ */
+void telemetry_tag_queued_input(uint32_t detected_us);
+
+/**
+ * Brackets one controller step, which claims the inputs tagged before it.
+ */
+void telemetry_begin_step(void);
+void telemetry_end_step(void);
+
+/**
+ * Notes that the display rows have been written, so that the current step's
+ * tag rides on the next frame.
+ */
+void telemetry_note_display_change(void);
+
+/**
+ * Notes that a frame has been flushed to the panel.
+ */
+void telemetry_note_frame_shown(void);
+
+#else
+
+static inline void telemetry_tag_input_from_isr(void) {}
+static inline void telemetry_tag_queued_input(uint32_t detected_us) {}
+static inline void telemetry_begin_step(void) {}
+static inline void telemetry_end_step(void) {}
+static inline void telemetry_note_display_change(void) {}
+static inline void telemetry_note_frame_shown(void) {}
+
+#endif //TELEMETRY_ENABLED && LATENCY_PROBE
+
+/**
+ * Copies the current statistics.
+ *
+ * @param snapshot Receives the statistics
+ */
+void telemetry_take_snapshot(struct telemetry_snapshot *snapshot);
+
+/**
+ * Clears the statistics and starts a new window.
+ */
+void telemetry_clear(void);
+
+/**
+ * Copies a boot phase's mark.
+ *
+ * @param phase The boot phase
+ * @param mark Receives the mark
+ * @return <code>true</code> if the phase has been marked
+ */
+bool telemetry_get_boot_mark(telemetry_boot_phase_t phase, struct telemetry_boot_mark *mark);
+
+/**
+ * Returns a phase's name, as used in the text report.
+ */
+char const *telemetry_phase_name(telemetry_phase_t phase);
+
+/**
+ * Returns a counter's name, as used in the text report.
+ */
+char const *telemetry_counter_name(telemetry_counter_t counter);
+
+/**
+ * Returns a boot phase's name, as used in the text report.
+ */
+char const *telemetry_boot_phase_name(telemetry_boot_phase_t phase);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_TELEMETRY_H
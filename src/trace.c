@@ -0,0 +1,71 @@
+/**************************************************************************/
+/**
+ *
+ * @file trace.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief @copybrief trace.h
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+// clang-format off
+#include <CowPi.h>
+#include "interrupt_support.h"
+#include "memory-map.h"
+#include "trace.h"
+// clang-format on
+
+_Static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0, "TRACE_CAPACITY must be a power of two");
+
+// events are recorded by the quadrature ISR, at ISR_PRIORITY_NORMAL, by the keypad ISR, below it, and by loop()
+#define TRACE_CEILING (ISR_PRIORITY_NORMAL)
+
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *)(TIMER_BASE_ADDRESS);
+static struct trace_event events[TRACE_CAPACITY];
+static volatile uint32_t next_event = 0;    // counts every event since boot; the low bits index the buffer
+static volatile uint32_t dropped_events = 0;
+static volatile bool is_paused = false;
+
+#if TRACE_ENABLED
+
+void trace_record(trace_event_type_t type, uint16_t payload) {
+    uint32_t timestamp = timer->raw_lower_word;
+    // an ISR may record between our claiming a slot and filling it, so claim and fill with the recording ISRs blocked
+    critical_section_t section = begin_critical_section(TRACE_CEILING);
+    if (is_paused) {
+        dropped_events++;
+    } else {
+        struct trace_event *event = &events[next_event & (TRACE_CAPACITY - 1)];
+        event->timestamp_us = timestamp;
+        event->type = (uint8_t) type;
+        event->payload = payload;
+        next_event++;
+    }
+    end_critical_section(section);
+}
+
+#endif //TRACE_ENABLED
+
+uint16_t trace_pause(uint32_t *total_recorded) {
+    critical_section_t section = begin_critical_section(TRACE_CEILING);
+    is_paused = true;
+    end_critical_section(section);
+    *total_recorded = next_event + dropped_events;
+    return (next_event < TRACE_CAPACITY) ? next_event : TRACE_CAPACITY;
+}
+
+struct trace_event const *trace_event_at(uint16_t index) {
+    uint32_t oldest = (next_event < TRACE_CAPACITY) ? 0 : next_event - TRACE_CAPACITY;
+    return &events[(oldest + index) & (TRACE_CAPACITY - 1)];
+}
+
+void trace_resume(void) {
+    is_paused = false;
+}
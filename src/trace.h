@@ -0,0 +1,104 @@
+/**************************************************************************/
+/**
+ *
+ * @file trace.h
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief A ring buffer of timestamped input and controller events, cheap
+ *      enough to record in production and to write from ISRs.
+ *
+ * Each event is eight bytes: a microsecond timestamp, a type, and a 16-bit
+ * payload whose meaning depends on the type. Once the buffer is full, each new
+ * event overwrites the oldest one.
+ *
+ * Recording can be compiled out with <code>-D TRACE_ENABLED=0</code>.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#ifndef COMBOLOCK_TRACE_H
+#define COMBOLOCK_TRACE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED (1)
+#endif
+
+// must be a power of two
+#define TRACE_CAPACITY (512)
+
+typedef enum {
+    TRACE_QUADRATURE = 1,       // payload: lock << 2 | quadrature bits (B << 1 | A)
+    TRACE_DETENT,               // payload: lock << 2 | direction_t
+    TRACE_KEYPRESS,             // payload: the key's character
+    TRACE_TRANSITION,           // payload: lock << 12 | event << 8 | next mode << 4 | previous mode
+    TRACE_INPUTS,               // payload: TRACE_INPUT_* bits for the buttons and switches
+} trace_event_type_t;
+
+#define TRACE_INPUT_LEFT_BUTTON_PRESSED (1 << 0)
+#define TRACE_INPUT_RIGHT_BUTTON_PRESSED (1 << 1)
+#define TRACE_INPUT_LEFT_SWITCH_RIGHT (1 << 2)
+#define TRACE_INPUT_RIGHT_SWITCH_RIGHT (1 << 3)
+
+struct trace_event {
+    uint32_t timestamp_us;
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t payload;
+};
+
+#if TRACE_ENABLED
+
+/**
+ * Appends an event to the trace. Safe to call from an ISR.
+ *
+ * @param type The kind of event
+ * @param payload Type-specific data
+ */
+void trace_record(trace_event_type_t type, uint16_t payload);
+
+#else
+
+static inline void trace_record(trace_event_type_t type, uint16_t payload) {}
+
+#endif //TRACE_ENABLED
+
+/**
+ * Stops recording so that the buffered events can be read consistently.
+ * Events that arrive while recording is paused are counted but not kept.
+ *
+ * @param total_recorded Receives the number of events recorded since boot,
+ *      including any that have been overwritten or dropped
+ * @return The number of buffered events
+ */
+uint16_t trace_pause(uint32_t *total_recorded);
+
+/**
+ * Retrieves a buffered event while recording is paused.
+ *
+ * @param index The event's position, counting from the oldest buffered event
+ * @return The event
+ */
+struct trace_event const *trace_event_at(uint16_t index);
+
+/**
+ * Resumes recording after <code>trace_pause()</code>.
+ */
+void trace_resume(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //COMBOLOCK_TRACE_H
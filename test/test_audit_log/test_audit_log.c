@@ -0,0 +1,142 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_audit_log.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Checks the audit log's batching, its recovery at boot, and its
+ *      indexed reads on the host against the mock flash.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <hardware/flash.h>
+#include <unity.h>
+#include "audit-log.h"
+#include "flash-storage.h"
+
+#define RECORDS_PER_PAGE (FLASH_STORAGE_PAGE_SIZE / sizeof(struct audit_record))
+// the first page of each sector is its index
+#define RECORDS_PER_SECTOR (RECORDS_PER_PAGE * (FLASH_STORAGE_SECTOR_SIZE / FLASH_STORAGE_PAGE_SIZE - 1))
+
+static struct audit_record records[64];
+
+static void record_unlocks(unsigned int count) {
+    for (unsigned int i = 0; i < count; i++) {
+        audit_log_record(AUDIT_UNLOCKED, 0, 0);
+        service_audit_log();
+    }
+}
+
+static bool is_first_data_page_erased(void) {
+    uint8_t const *page = mock_flash + AUDIT_LOG_OFFSET + FLASH_STORAGE_PAGE_SIZE;
+    for (unsigned int i = 0; i < FLASH_STORAGE_PAGE_SIZE; i++) {
+        if (page[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void assert_consecutive(uint32_t first_sequence_number, unsigned int count) {
+    for (unsigned int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(first_sequence_number + i, records[i].sequence_number);
+    }
+}
+
+void setUp(void) {
+    mock_cowpi_reset();
+    mock_flash_erase_all();
+    initialize_audit_log();
+}
+
+void tearDown(void) {}
+
+void test_records_wait_in_ram_until_a_page_fills(void) {
+    record_unlocks(RECORDS_PER_PAGE - 1);
+    TEST_ASSERT_TRUE(is_first_data_page_erased());
+    TEST_ASSERT_EQUAL_UINT32(RECORDS_PER_PAGE - 1, audit_log_read(0, records, 64));
+    record_unlocks(1);
+    TEST_ASSERT_FALSE(is_first_data_page_erased());
+    initialize_audit_log();
+    TEST_ASSERT_EQUAL_UINT32(RECORDS_PER_PAGE, audit_log_next_sequence_number());
+    TEST_ASSERT_EQUAL_UINT32(RECORDS_PER_PAGE, audit_log_read(0, records, 64));
+    assert_consecutive(0, RECORDS_PER_PAGE);
+}
+
+void test_an_alarm_is_programmed_on_the_next_service(void) {
+    audit_log_record(AUDIT_BAD_ATTEMPT, 0, 3);
+    audit_log_record(AUDIT_ALARM, 0, 0);
+    service_audit_log();
+    initialize_audit_log();
+    TEST_ASSERT_EQUAL_UINT32(2, audit_log_read(0, records, 64));
+    TEST_ASSERT_EQUAL_UINT8(AUDIT_BAD_ATTEMPT, records[0].event);
+    TEST_ASSERT_EQUAL_UINT32(3, records[0].detail);
+    TEST_ASSERT_EQUAL_UINT8(AUDIT_ALARM, records[1].event);
+}
+
+void test_a_batch_is_programmed_once_it_has_waited(void) {
+    mock_advance_time_us(5000);
+    audit_log_record(AUDIT_COMBINATION_CHANGED, 1, 0);
+    mock_advance_time_us(AUDIT_LOG_FLUSH_AFTER_uS - 1);
+    service_audit_log();
+    TEST_ASSERT_TRUE(is_first_data_page_erased());
+    mock_advance_time_us(1);
+    service_audit_log();
+    initialize_audit_log();
+    TEST_ASSERT_EQUAL_UINT32(1, audit_log_read(0, records, 64));
+    TEST_ASSERT_EQUAL_UINT8(1, records[0].lock);
+    TEST_ASSERT_EQUAL_UINT32(5, records[0].timestamp_ms);
+}
+
+void test_records_lost_with_the_batch_leave_no_gap(void) {
+    record_unlocks(3);
+    audit_log_flush();
+    record_unlocks(2);
+    // power fails before the second batch is programmed
+    initialize_audit_log();
+    TEST_ASSERT_EQUAL_UINT32(3, audit_log_next_sequence_number());
+    record_unlocks(1);
+    TEST_ASSERT_EQUAL_UINT32(4, audit_log_read(0, records, 64));
+    assert_consecutive(0, 4);
+}
+
+void test_a_torn_record_is_skipped(void) {
+    record_unlocks(3);
+    audit_log_flush();
+    // the second record was only partly programmed when power failed
+    mock_flash[AUDIT_LOG_OFFSET + FLASH_STORAGE_PAGE_SIZE + sizeof(struct audit_record)] = 0x00;
+    initialize_audit_log();
+    TEST_ASSERT_EQUAL_UINT32(2, audit_log_read(0, records, 64));
+    TEST_ASSERT_EQUAL_UINT32(0, records[0].sequence_number);
+    TEST_ASSERT_EQUAL_UINT32(2, records[1].sequence_number);
+}
+
+void test_a_full_log_drops_its_oldest_sector(void) {
+    record_unlocks(AUDIT_LOG_NUMBER_OF_SECTORS * RECORDS_PER_SECTOR + 20);
+    initialize_audit_log();
+    TEST_ASSERT_EQUAL_UINT32(AUDIT_LOG_NUMBER_OF_SECTORS * RECORDS_PER_SECTOR + 16, audit_log_next_sequence_number());
+    TEST_ASSERT_EQUAL_UINT32(1, audit_log_read(0, records, 1));
+    TEST_ASSERT_EQUAL_UINT32(RECORDS_PER_SECTOR, records[0].sequence_number);
+    // a read from the middle goes through the indices to the record it wants
+    TEST_ASSERT_EQUAL_UINT32(40, audit_log_read(1000, records, 40));
+    assert_consecutive(1000, 40);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_wait_in_ram_until_a_page_fills);
+    RUN_TEST(test_an_alarm_is_programmed_on_the_next_service);
+    RUN_TEST(test_a_batch_is_programmed_once_it_has_waited);
+    RUN_TEST(test_records_lost_with_the_batch_leave_no_gap);
+    RUN_TEST(test_a_torn_record_is_skipped);
+    RUN_TEST(test_a_full_log_drops_its_oldest_sector);
+    return UNITY_END();
+}
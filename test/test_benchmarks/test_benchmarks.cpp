@@ -0,0 +1,245 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_benchmarks.cpp
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief On-target microbenchmarks of the lock's ISRs, its controller step,
+ *      the display, and its string formatting.
+ *
+ * Run with <code>pio test -e benchmarks -e benchmarks_onebit</code>, one
+ * build per display backend. Each benchmark prints one comma-separated line
+ * that starts with <code>BENCH,</code>; the first such line is the header.
+ *
+ * Durations are taken from the RP2040's microsecond timer and, in processor
+ * cycles, from SysTick. SysTick is a 24-bit down-counter that the RTOS may
+ * already be using with a shorter reload; a sample too long for SysTick to
+ * measure without wrapping twice reports its cycles as microseconds times the
+ * clock rate instead. The cost of taking the timestamps is measured first and
+ * subtracted from the cycle counts.
+ *
+ * The ISRs are timed with interrupts disabled, so that nothing preempts them.
+ * Everything else is timed with interrupts enabled, as it runs in
+ * <code>loop()</code>; the minimum is the figure least disturbed by ISRs.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <hardware/clocks.h>
+#include <hardware/sync.h>
+#include <unity.h>
+#include "display.h"
+#include "format.h"
+#include "memory-map.h"
+
+extern "C" {
+#include "lock-controller.h"
+#include "rotary-encoder.h"
+#include "servomotor.h"
+
+extern void (*const rotary_encoder_isr)(void);
+extern void (*const keypad_isr)(void);
+extern void (*const servo_timer_isr)(void);
+bool force_lock_mode(unsigned int new_mode);
+}
+
+#if __has_include(<OneBitDisplay.h>)
+static char constexpr DISPLAY_BACKEND[] = "OneBitDisplay";
+#else
+static char constexpr DISPLAY_BACKEND[] = "Adafruit_SSD1306";
+#endif
+
+// in the order of lock_mode_t in lock-controller.c
+static char const *const MODE_NAMES[] = {"LOCKED", "UNLOCKED", "ALARMED", "CHANGING"};
+
+typedef struct {
+    uint32_t control_and_status;
+    uint32_t reload_value;
+    uint32_t current_value;
+    uint32_t calibration;
+} systick_t;
+
+static uint32_t constexpr SYSTICK_ENABLE = 1u << 0;
+static uint32_t constexpr SYSTICK_PROCESSOR_CLOCK = 1u << 2;
+
+static volatile systick_t *systick = (systick_t *) (SYSTICK_BASE_ADDRESS);
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *) (TIMER_BASE_ADDRESS);
+static uint32_t cycles_per_us;
+static uint32_t timestamp_overhead_cycles = 0;
+
+struct statistics {
+    uint32_t minimum;
+    uint32_t maximum;
+    uint64_t total;
+
+    void add(uint32_t sample) {
+        minimum = (sample < minimum) ? sample : minimum;
+        maximum = (sample > maximum) ? sample : maximum;
+        total += sample;
+    }
+};
+
+static void do_nothing() {}
+
+/*
+ * Calls prepare() then body() the given number of times, timing only body(),
+ * and prints the results under the given name.
+ */
+template<typename Prepare, typename Body>
+static statistics benchmark(char const *name, unsigned int iterations, bool disable_interrupts,
+                            Prepare prepare, Body body) {
+    statistics cycles = {UINT32_MAX, 0, 0};
+    statistics microseconds = {UINT32_MAX, 0, 0};
+    for (unsigned int i = 0; i < iterations; i++) {
+        prepare();
+        uint32_t interrupt_status = disable_interrupts ? save_and_disable_interrupts() : 0;
+        uint32_t start_us = timer->raw_lower_word;
+        uint32_t start_ticks = systick->current_value;
+        body();
+        uint32_t end_ticks = systick->current_value;
+        uint32_t end_us = timer->raw_lower_word;
+        if (disable_interrupts) {
+            restore_interrupts(interrupt_status);
+        }
+        uint32_t elapsed_us = end_us - start_us;
+        uint32_t period = (systick->reload_value & 0xFFFFFF) + 1;
+        uint32_t elapsed_cycles;
+        if ((uint64_t) (elapsed_us + 1) * cycles_per_us < period) {
+            // SysTick counts down and wrapped at most once
+            elapsed_cycles = (start_ticks - end_ticks + period) % period;
+        } else {
+            elapsed_cycles = elapsed_us * cycles_per_us;
+        }
+        elapsed_cycles = (elapsed_cycles > timestamp_overhead_cycles) ? elapsed_cycles - timestamp_overhead_cycles : 0;
+        cycles.add(elapsed_cycles);
+        microseconds.add(elapsed_us);
+    }
+    char line[160];
+    snprintf(line, sizeof(line), "BENCH,%s,%s,%u,%lu,%lu,%lu,%lu,%lu,%lu", DISPLAY_BACKEND, name, iterations,
+             (unsigned long) cycles.minimum, (unsigned long) (cycles.total / iterations), (unsigned long) cycles.maximum,
+             (unsigned long) microseconds.minimum, (unsigned long) (microseconds.total / iterations),
+             (unsigned long) microseconds.maximum);
+    Serial.println(line);
+    return cycles;
+}
+
+template<typename Body>
+static statistics benchmark(char const *name, unsigned int iterations, bool disable_interrupts, Body body) {
+    return benchmark(name, iterations, disable_interrupts, do_nothing, body);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_timestamp_overhead(void) {
+    timestamp_overhead_cycles = 0;
+    timestamp_overhead_cycles = benchmark("timestamp_overhead", 1000, true, do_nothing).minimum;
+}
+
+void test_quadrature_isr(void) {
+    benchmark("handle_quadrature_interrupt", 1000, true, rotary_encoder_isr);
+    // discard the phantom detents that the calls may have produced
+    get_direction();
+}
+
+void test_servo_timer_isr(void) {
+    benchmark("servo_handle_timer_interrupt", 1000, true, servo_timer_isr);
+}
+
+void test_keypad_scan_isr(void) {
+    benchmark("scan_keypad", 1000, true, keypad_isr);
+}
+
+void test_control_lock_in_each_mode(void) {
+    for (unsigned int mode = 0; force_lock_mode(mode); mode++) {
+        char name[40];
+        snprintf(name, sizeof(name), "control_lock_%s", MODE_NAMES[mode]);
+        // each step may transition out of the mode, so re-enter it before every step
+        benchmark(name, 200, false, [mode] { force_lock_mode(mode); }, control_lock);
+    }
+    force_lock_mode(0);
+}
+
+void test_display_string(void) {
+    benchmark("display_string", 1000, false, [] { display_string(2, "BENCHMARK"); });
+}
+
+void test_refresh_display(void) {
+    benchmark("refresh_display", 50, false, refresh_display);
+}
+
+void test_count_visits(void) {
+    benchmark("count_visits", 50, false, [] { count_visits(7); });
+}
+
+// each pair formats the same text with snprintf() and with FORMAT(), into a buffer that cannot be optimized away
+static char format_storage[32];
+static char *volatile format_buffer = format_storage;
+static volatile int32_t format_argument = 12;
+
+void test_format_rotation_counts(void) {
+    benchmark("snprintf_rotation_counts", 1000, false,
+              [] { snprintf(format_buffer, 32, "CW:%2d CCW:%2d", (int) format_argument, (int) format_argument); });
+    benchmark("FORMAT_rotation_counts", 1000, false, [] {
+        FORMAT(format_buffer, "CW:", decimal_field(format_argument, 2), " CCW:", decimal_field(format_argument, 2));
+    });
+}
+
+void test_format_padded_string(void) {
+    benchmark("snprintf_padded_string", 1000, false,
+              [] { snprintf(format_buffer, 32, "%-*s", 21, "BENCHMARK"); });
+    benchmark("FORMAT_padded_string", 1000, false,
+              [] { FORMAT(format_buffer, left_aligned_field("BENCHMARK", 21)); });
+}
+
+void test_format_hex_byte(void) {
+    benchmark("snprintf_hex_byte", 1000, false,
+              [] { snprintf(format_buffer, 32, "%02X", (unsigned int) format_argument); });
+    benchmark("FORMAT_hex_byte", 1000, false,
+              [] { FORMAT(format_buffer, hex_field(format_argument, 2)); });
+}
+
+void setup() {
+    // let the test runner open the serial port
+    delay(2000);
+    cowpi_setup(0,
+                (cowpi_display_module_t) {.display_module = NO_MODULE},
+                (cowpi_display_module_protocol_t) {.protocol = NO_PROTOCOL}
+               );
+    initialize_display(21);
+    initialize_rotary_encoder();
+    initialize_servo();
+    initialize_lock_controller();
+
+    cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+    if (!(systick->control_and_status & SYSTICK_ENABLE)) {
+        systick->reload_value = 0xFFFFFF;
+        systick->current_value = 0;
+        systick->control_and_status = SYSTICK_PROCESSOR_CLOCK | SYSTICK_ENABLE;
+    }
+    Serial.println("BENCH,backend,benchmark,iterations,min_cycles,mean_cycles,max_cycles,min_us,mean_us,max_us");
+
+    UNITY_BEGIN();
+    RUN_TEST(test_timestamp_overhead);
+    RUN_TEST(test_quadrature_isr);
+    RUN_TEST(test_servo_timer_isr);
+    RUN_TEST(test_keypad_scan_isr);
+    RUN_TEST(test_control_lock_in_each_mode);
+    RUN_TEST(test_display_string);
+    RUN_TEST(test_refresh_display);
+    RUN_TEST(test_count_visits);
+    RUN_TEST(test_format_rotation_counts);
+    RUN_TEST(test_format_padded_string);
+    RUN_TEST(test_format_hex_byte);
+    UNITY_END();
+}
+
+void loop() {}
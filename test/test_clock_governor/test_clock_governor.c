@@ -0,0 +1,160 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_clock_governor.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Checks the clock governor's choice of frequency, and its accounting,
+ *      on the host against the mock clocks.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <hardware/clocks.h>
+#include <hardware/i2c.h>
+#include <unity.h>
+#include "clock-governor.h"
+#include "input-activity.h"
+#include "servomotor.h"
+#include "telemetry.h"
+
+static void idle_in(lock_mode_t mode) {
+    mock_advance_time_us(CLOCK_IDLE_AFTER_uS);
+    govern_clock(mode);
+}
+
+void setUp(void) {
+    mock_cowpi_reset();
+    initialize_clock_governor();
+}
+
+void tearDown(void) {}
+
+void test_the_peripheral_clock_does_not_follow_the_system_clock(void) {
+    TEST_ASSERT_EQUAL_UINT32(48 * MHZ, clock_get_hz(clk_peri));
+    idle_in(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(48 * MHZ, clock_get_hz(clk_peri));
+}
+
+void test_an_idle_lock_settles_to_its_mode_profile(void) {
+    govern_clock(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_ACTIVE_kHZ, get_clock_khz());
+    idle_in(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_LOCKED_kHZ, get_clock_khz());
+    govern_clock(UNLOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_UNLOCKED_kHZ, get_clock_khz());
+    govern_clock(CHANGING);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_CHANGING_kHZ, get_clock_khz());
+}
+
+void test_input_raises_the_clock_until_the_lock_is_idle_again(void) {
+    idle_in(LOCKED);
+    mock_cowpi_inputs.left_button_pressed = true;
+    govern_clock(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_ACTIVE_kHZ, get_clock_khz());
+    mock_advance_time_us(CLOCK_IDLE_AFTER_uS / 2);
+    // an input caught by an ISR restarts the idle time
+    note_input_activity();
+    govern_clock(LOCKED);
+    mock_advance_time_us(CLOCK_IDLE_AFTER_uS - 1);
+    govern_clock(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_ACTIVE_kHZ, get_clock_khz());
+    mock_advance_time_us(1);
+    govern_clock(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_LOCKED_kHZ, get_clock_khz());
+}
+
+void test_transfers_hold_the_clock_at_the_transfer_floor(void) {
+    idle_in(LOCKED);
+    raise_clock_for_transfer();
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_TRANSFER_kHZ, get_clock_khz());
+    uint32_t changes = mock_sys_clock_changes;
+    for (int i = 0; i < 10; i++) {
+        mock_advance_time_us(CLOCK_IDLE_AFTER_uS / 10);
+        govern_clock(LOCKED);
+        raise_clock_for_transfer();
+    }
+    // a refresh every pass does not change the clock every pass
+    TEST_ASSERT_EQUAL_UINT32(changes, mock_sys_clock_changes);
+    idle_in(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_LOCKED_kHZ, get_clock_khz());
+}
+
+void test_a_kept_i2c_bus_keeps_its_baud_rate(void) {
+    // the display's library sets the rate once, at the clock it boots at
+    i2c_set_baudrate(i2c0, 400000);
+    keep_i2c_baud_rate(0, 400000);
+    idle_in(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_LOCKED_kHZ, get_clock_khz());
+    TEST_ASSERT_EQUAL_UINT32(400000, mock_i2c_scl_hz(i2c0));
+    raise_clock_for_transfer();
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_TRANSFER_kHZ, get_clock_khz());
+    TEST_ASSERT_EQUAL_UINT32(400000, mock_i2c_scl_hz(i2c0));
+}
+
+void test_the_rtos_tick_keeps_its_period(void) {
+    mock_systick[0] = 0x7;      // enabled, interrupting, processor clock
+    mock_systick[1] = CLOCK_ACTIVE_kHZ - 1;
+    idle_in(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_LOCKED_kHZ - 1, mock_systick[1]);
+    mock_systick[0] = 0x5;      // free-running, as the ISR profiler leaves it
+    mock_systick[1] = 0xFFFFFF;
+    note_input_activity();
+    govern_clock(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_ACTIVE_kHZ, get_clock_khz());
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFF, mock_systick[1]);
+}
+
+void test_residency_accounts_for_all_of_the_time(void) {
+    struct clock_residency residency[MAXIMUM_CLOCK_LEVELS];
+    idle_in(LOCKED);
+    mock_advance_time_us(3000000);
+    unsigned int count = get_clock_residency(residency, MAXIMUM_CLOCK_LEVELS);
+    TEST_ASSERT_EQUAL_UINT32(2, count);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_ACTIVE_kHZ, residency[0].khz);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_IDLE_AFTER_uS, (uint32_t) residency[0].total_us);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_LOCKED_kHZ, residency[1].khz);
+    TEST_ASSERT_EQUAL_UINT32(1, residency[1].entries);
+    TEST_ASSERT_EQUAL_UINT32(3000000, (uint32_t) residency[1].total_us);
+    clear_clock_residency();
+    mock_advance_time_us(500);
+    count = get_clock_residency(residency, MAXIMUM_CLOCK_LEVELS);
+    TEST_ASSERT_EQUAL_UINT32(1, count);
+    TEST_ASSERT_EQUAL_UINT32(500, (uint32_t) residency[0].total_us);
+}
+
+void test_a_switch_is_left_for_a_gap_in_the_servo_signal(void) {
+    struct telemetry_snapshot snapshot;
+    initialize_servo();
+    telemetry_clear();
+    // the pulses rose 400 µs ago
+    mock_advance_time_us(CLOCK_IDLE_AFTER_uS + 500);
+    govern_clock(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_ACTIVE_kHZ, get_clock_khz());
+    mock_advance_time_us(3000);
+    govern_clock(LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(CLOCK_LOCKED_kHZ, get_clock_khz());
+    telemetry_take_snapshot(&snapshot);
+    TEST_ASSERT_EQUAL_UINT32(1, snapshot.phases[TELEMETRY_CLOCK_SWITCH].count);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_the_peripheral_clock_does_not_follow_the_system_clock);
+    RUN_TEST(test_an_idle_lock_settles_to_its_mode_profile);
+    RUN_TEST(test_input_raises_the_clock_until_the_lock_is_idle_again);
+    RUN_TEST(test_transfers_hold_the_clock_at_the_transfer_floor);
+    RUN_TEST(test_a_kept_i2c_bus_keeps_its_baud_rate);
+    RUN_TEST(test_the_rtos_tick_keeps_its_period);
+    RUN_TEST(test_residency_accounts_for_all_of_the_time);
+    // last, because the servo's state outlives the mock's reset
+    RUN_TEST(test_a_switch_is_left_for_a_gap_in_the_servo_signal);
+    return UNITY_END();
+}
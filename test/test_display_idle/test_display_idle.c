@@ -0,0 +1,68 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_display_idle.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Checks on the host which lock modes let the display sleep.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <unity.h>
+#include "display-idle.h"
+#include "input-activity.h"
+
+void setUp(void) {
+    mock_cowpi_reset();
+    set_display_idle_timeout(DISPLAY_IDLE_TIMEOUT_uS);
+    display_may_sleep(LOCKED);
+}
+
+void tearDown(void) {}
+
+void test_a_locked_display_sleeps_once_idle(void) {
+    mock_advance_time_us(DISPLAY_IDLE_TIMEOUT_uS - 1);
+    TEST_ASSERT_FALSE(display_may_sleep(LOCKED));
+    mock_advance_time_us(1);
+    TEST_ASSERT_TRUE(display_may_sleep(LOCKED));
+    note_input_activity();
+    TEST_ASSERT_FALSE(display_may_sleep(LOCKED));
+}
+
+void test_an_alarm_stays_lit_past_the_idle_timeout(void) {
+    display_may_sleep(ALARMED);
+    mock_advance_time_us(2 * DISPLAY_IDLE_TIMEOUT_uS);
+    TEST_ASSERT_FALSE(display_may_sleep(ALARMED));
+}
+
+void test_only_a_locked_lock_lets_the_display_sleep(void) {
+    mock_advance_time_us(DISPLAY_IDLE_TIMEOUT_uS);
+    TEST_ASSERT_FALSE(display_may_sleep(UNLOCKED));
+    TEST_ASSERT_FALSE(display_may_sleep(CHANGING));
+    TEST_ASSERT_FALSE(display_may_sleep(ALARMED));
+}
+
+void test_the_idle_time_starts_over_when_the_lock_is_locked_again(void) {
+    mock_advance_time_us(DISPLAY_IDLE_TIMEOUT_uS);
+    display_may_sleep(ALARMED);
+    TEST_ASSERT_FALSE(display_may_sleep(LOCKED));
+    mock_advance_time_us(DISPLAY_IDLE_TIMEOUT_uS);
+    TEST_ASSERT_TRUE(display_may_sleep(LOCKED));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_a_locked_display_sleeps_once_idle);
+    RUN_TEST(test_an_alarm_stays_lit_past_the_idle_timeout);
+    RUN_TEST(test_only_a_locked_lock_lets_the_display_sleep);
+    RUN_TEST(test_the_idle_time_starts_over_when_the_lock_is_locked_again);
+    return UNITY_END();
+}
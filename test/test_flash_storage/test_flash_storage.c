@@ -0,0 +1,88 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_flash_storage.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Checks on the host that the servo signal and the rotary encoder keep
+ *      working while flash is erased or programmed.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <hardware/flash.h>
+#include <unity.h>
+#include "flash-storage.h"
+#include "interrupt_support.h"
+#include "encoder-bank.h"
+#include "servomotor.h"
+#include "telemetry.h"
+
+#define A_WIPER_PIN (16)
+#define WIPER_PINS (0x3u << A_WIPER_PIN)
+#define SERVO_TICK_uS (100)
+
+// the wiper levels, B then A, that one detent passes through
+static uint8_t const clockwise_detent[] = {0b10, 0b00, 0b01, 0b11};
+
+void setUp(void) {
+    mock_cowpi_reset();
+    mock_flash_erase_all();
+    telemetry_clear();
+    mock_set_input_pins(WIPER_PINS, WIPER_PINS);
+    initialize_rotary_encoder();
+    initialize_servo();
+}
+
+void tearDown(void) {}
+
+void test_the_servo_ticks_through_an_erase(void) {
+    uint32_t ticks = telemetry_counters[TELEMETRY_SERVO_INTERRUPTS];
+    flash_storage_erase_sector(CONFIG_STORE_OFFSET);
+    TEST_ASSERT_EQUAL_UINT32(MOCK_FLASH_SECTOR_ERASE_uS / SERVO_TICK_uS,
+                             telemetry_counters[TELEMETRY_SERVO_INTERRUPTS] - ticks);
+}
+
+void test_a_detent_turned_during_a_stall_is_decoded_afterward(void) {
+    flash_stall_t stall = begin_flash_stall();
+    begin_sampling_wipers();
+    for (int i = 0; i < 4; i++) {
+        mock_advance_time_us(2000);
+        mock_set_input_pins((uint32_t) clockwise_detent[i] << A_WIPER_PIN, WIPER_PINS);
+    }
+    mock_advance_time_us(2000);
+    // the pin interrupt was blocked throughout
+    TEST_ASSERT_EQUAL_UINT32(0, telemetry_counters[TELEMETRY_QUADRATURE_INTERRUPTS]);
+    TEST_ASSERT_EQUAL_INT(STATIONARY, get_direction());
+    finish_sampling_wipers();
+    end_flash_stall(stall);
+    TEST_ASSERT_EQUAL_INT(CLOCKWISE, get_direction());
+}
+
+void test_a_change_after_the_last_sample_is_not_lost(void) {
+    flash_stall_t stall = begin_flash_stall();
+    begin_sampling_wipers();
+    mock_advance_time_us(2000);
+    mock_set_input_pins((uint32_t) clockwise_detent[0] << A_WIPER_PIN, WIPER_PINS);
+    mock_advance_time_us(2000);
+    // the change that completes the detent comes before the sampler's next tick
+    mock_set_input_pins((uint32_t) clockwise_detent[1] << A_WIPER_PIN, WIPER_PINS);
+    finish_sampling_wipers();
+    end_flash_stall(stall);
+    TEST_ASSERT_EQUAL_INT(CLOCKWISE, get_direction());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_the_servo_ticks_through_an_erase);
+    RUN_TEST(test_a_detent_turned_during_a_stall_is_decoded_afterward);
+    RUN_TEST(test_a_change_after_the_last_sample_is_not_lost);
+    return UNITY_END();
+}
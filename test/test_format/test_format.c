@@ -0,0 +1,116 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_format.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Checks the formatting writers against <code>snprintf()</code> on the
+ *      host.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "format.h"
+
+static int32_t const signed_samples[] = {
+        0, 1, 7, 9, 10, 15, 99, 100, 12345, 999999999, 1000000000, INT32_MAX,
+        -1, -9, -10, -12345, INT32_MIN
+};
+
+static uint32_t const unsigned_samples[] = {
+        0, 1, 9, 10, 0xF, 0x10, 0xFF, 0x100, 4000000000u, UINT32_MAX
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_signed_matches_printf(void) {
+    char expected[32];
+    char actual[32];
+    for (unsigned int i = 0; i < sizeof(signed_samples) / sizeof(signed_samples[0]); i++) {
+        for (unsigned int width = 0; width <= 12; width++) {
+            snprintf(expected, sizeof(expected), "%*ld", (int) width, (long) signed_samples[i]);
+            char *end = format_signed(actual, signed_samples[i], width, ' ');
+            TEST_ASSERT_EQUAL_STRING(expected, actual);
+            TEST_ASSERT_EQUAL_UINT32(strlen(expected), end - actual);
+            snprintf(expected, sizeof(expected), "%0*ld", (int) width, (long) signed_samples[i]);
+            format_signed(actual, signed_samples[i], width, '0');
+            TEST_ASSERT_EQUAL_STRING(expected, actual);
+        }
+    }
+}
+
+void test_unsigned_and_hex_match_printf(void) {
+    char expected[32];
+    char actual[32];
+    for (unsigned int i = 0; i < sizeof(unsigned_samples) / sizeof(unsigned_samples[0]); i++) {
+        for (unsigned int width = 0; width <= 12; width++) {
+            snprintf(expected, sizeof(expected), "%*lu", (int) width, (unsigned long) unsigned_samples[i]);
+            format_unsigned(actual, unsigned_samples[i], width, ' ');
+            TEST_ASSERT_EQUAL_STRING(expected, actual);
+            snprintf(expected, sizeof(expected), "%0*lX", (int) width, (unsigned long) unsigned_samples[i]);
+            char *end = format_hex(actual, unsigned_samples[i], width);
+            TEST_ASSERT_EQUAL_STRING(expected, actual);
+            TEST_ASSERT_EQUAL_UINT32(strlen(expected), end - actual);
+        }
+    }
+}
+
+void test_strings_match_printf(void) {
+    static char const *const samples[] = {"", "a", "SERVO", "20240101", "a longer string than any field"};
+    char expected[48];
+    char actual[48];
+    for (unsigned int i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        for (unsigned int width = 0; width <= 21; width++) {
+            snprintf(expected, sizeof(expected), "%-*s", (int) width, samples[i]);
+            FORMAT(actual, left_aligned_field(samples[i], width));
+            TEST_ASSERT_EQUAL_STRING(expected, actual);
+            snprintf(expected, sizeof(expected), "%*s", (int) width, samples[i]);
+            FORMAT(actual, right_aligned_field(samples[i], width));
+            TEST_ASSERT_EQUAL_STRING(expected, actual);
+            snprintf(expected, sizeof(expected), "%-*.*s", (int) width, (int) width, samples[i]);
+            FORMAT(actual, clipped_left_aligned_field(samples[i], width));
+            TEST_ASSERT_EQUAL_STRING(expected, actual);
+            snprintf(expected, sizeof(expected), "%*.*s", (int) width, (int) width, samples[i]);
+            FORMAT(actual, clipped_right_aligned_field(samples[i], width));
+            TEST_ASSERT_EQUAL_STRING(expected, actual);
+        }
+    }
+}
+
+void test_format_chains_pieces(void) {
+    char buffer[48];
+    uint8_t tries = 2;
+    char *end = FORMAT(buffer, "CW:", decimal_field(3, 2), " CCW:", decimal_field(12, 2));
+    TEST_ASSERT_EQUAL_STRING("CW: 3 CCW:12", buffer);
+    TEST_ASSERT_EQUAL_UINT32(12, end - buffer);
+    FORMAT(buffer, "BAD ATTEMPT #", tries);
+    TEST_ASSERT_EQUAL_STRING("BAD ATTEMPT #2", buffer);
+    end = FORMAT(buffer, "Combo: ", zero_padded_field(5, 2));
+    FORMAT(end, "-", zero_padded_field(10, 2), "-", zero_padded_field(15, 2));
+    TEST_ASSERT_EQUAL_STRING("Combo: 05-10-15", buffer);
+    FORMAT(buffer, 1, 2, 3, 4, 5, 6, 7, 8, 9, hex_field(0xA, 1));
+    TEST_ASSERT_EQUAL_STRING("123456789A", buffer);
+    FORMAT(buffer, -42, " ", 4000000000u);
+    TEST_ASSERT_EQUAL_STRING("-42 4000000000", buffer);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_signed_matches_printf);
+    RUN_TEST(test_unsigned_and_hex_match_printf);
+    RUN_TEST(test_strings_match_printf);
+    RUN_TEST(test_format_chains_pieces);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_keypad.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Checks the keypad's debouncing and event queue on the host, with the
+ *      scan's timer ISR fired by the virtual clock.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <unity.h>
+#include "keypad.h"
+#include "telemetry.h"
+#include "trace.h"
+
+#define DEBOUNCE_TIME_uS (KEYPAD_DEBOUNCE_SCANS * KEYPAD_SCAN_PERIOD_uS)
+
+static void hold_key(char key, uint32_t duration_us) {
+    mock_cowpi_inputs.key = key;
+    mock_advance_time_us(duration_us);
+}
+
+void setUp(void) {
+    mock_cowpi_reset();
+    telemetry_clear();
+    initialize_keypad();
+}
+
+void tearDown(void) {}
+
+void test_press_and_release_are_queued_with_the_time_first_seen(void) {
+    key_event_t event;
+    mock_advance_time_us(KEYPAD_SCAN_PERIOD_uS / 2);
+    hold_key('7', 2 * DEBOUNCE_TIME_uS);
+    hold_key('\0', 2 * DEBOUNCE_TIME_uS);
+    TEST_ASSERT_TRUE(take_key_event(&event));
+    TEST_ASSERT_EQUAL_INT('7', event.key);
+    TEST_ASSERT_EQUAL_INT(KEY_PRESSED, event.action);
+    TEST_ASSERT_EQUAL_UINT32(KEYPAD_SCAN_PERIOD_uS, event.timestamp_us);
+    TEST_ASSERT_TRUE(take_key_event(&event));
+    TEST_ASSERT_EQUAL_INT('7', event.key);
+    TEST_ASSERT_EQUAL_INT(KEY_RELEASED, event.action);
+    TEST_ASSERT_EQUAL_UINT32(KEYPAD_SCAN_PERIOD_uS + 2 * DEBOUNCE_TIME_uS, event.timestamp_us);
+    TEST_ASSERT_FALSE(take_key_event(&event));
+}
+
+void test_bounces_shorter_than_the_debounce_time_are_ignored(void) {
+    key_event_t event;
+    for (int i = 0; i < 10; i++) {
+        hold_key('5', DEBOUNCE_TIME_uS - KEYPAD_SCAN_PERIOD_uS);
+        hold_key('\0', KEYPAD_SCAN_PERIOD_uS);
+    }
+    TEST_ASSERT_FALSE(take_key_event(&event));
+}
+
+void test_changing_keys_releases_the_first(void) {
+    key_event_t event;
+    hold_key('1', 2 * DEBOUNCE_TIME_uS);
+    hold_key('2', 2 * DEBOUNCE_TIME_uS);
+    TEST_ASSERT_TRUE(take_key_event(&event));
+    TEST_ASSERT_TRUE(event.key == '1' && event.action == KEY_PRESSED);
+    TEST_ASSERT_TRUE(take_key_event(&event));
+    TEST_ASSERT_TRUE(event.key == '1' && event.action == KEY_RELEASED);
+    TEST_ASSERT_TRUE(take_key_event(&event));
+    TEST_ASSERT_TRUE(event.key == '2' && event.action == KEY_PRESSED);
+}
+
+void test_a_slow_reader_loses_only_what_overflows_the_queue(void) {
+    static char const keys[] = "0123456789";
+    key_event_t event;
+    for (int i = 0; keys[i] != '\0'; i++) {
+        hold_key(keys[i], 2 * DEBOUNCE_TIME_uS);
+        hold_key('\0', 2 * DEBOUNCE_TIME_uS);
+    }
+    for (int i = 0; i < KEY_EVENT_QUEUE_CAPACITY; i++) {
+        TEST_ASSERT_TRUE(take_key_event(&event));
+        TEST_ASSERT_EQUAL_INT(keys[i / 2], event.key);
+        TEST_ASSERT_EQUAL_INT((i % 2) ? KEY_RELEASED : KEY_PRESSED, event.action);
+    }
+    TEST_ASSERT_FALSE(take_key_event(&event));
+    TEST_ASSERT_EQUAL_UINT32(2 * (sizeof(keys) - 1) - KEY_EVENT_QUEUE_CAPACITY,
+                             telemetry_counters[TELEMETRY_DROPPED_KEY_EVENTS]);
+}
+
+void test_discarded_events_are_not_taken(void) {
+    key_event_t event;
+    hold_key('9', 2 * DEBOUNCE_TIME_uS);
+    discard_key_events();
+    TEST_ASSERT_FALSE(take_key_event(&event));
+    hold_key('\0', 2 * DEBOUNCE_TIME_uS);
+    TEST_ASSERT_TRUE(take_key_event(&event));
+    TEST_ASSERT_TRUE(event.key == '9' && event.action == KEY_RELEASED);
+}
+
+void test_a_press_is_traced_when_queued_and_every_scan_is_counted(void) {
+    uint32_t recorded;
+    hold_key('4', 2 * DEBOUNCE_TIME_uS);
+    // nothing has taken the event
+    uint16_t count = trace_pause(&recorded);
+    struct trace_event const *newest = trace_event_at(count - 1);
+    TEST_ASSERT_EQUAL_UINT8(TRACE_KEYPRESS, newest->type);
+    TEST_ASSERT_EQUAL_UINT16('4', newest->payload);
+    TEST_ASSERT_EQUAL_UINT32(KEYPAD_SCAN_PERIOD_uS * KEYPAD_DEBOUNCE_SCANS, newest->timestamp_us);
+    trace_resume();
+    TEST_ASSERT_EQUAL_UINT32(2 * KEYPAD_DEBOUNCE_SCANS, telemetry_counters[TELEMETRY_KEYPAD_INTERRUPTS]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_press_and_release_are_queued_with_the_time_first_seen);
+    RUN_TEST(test_bounces_shorter_than_the_debounce_time_are_ignored);
+    RUN_TEST(test_changing_keys_releases_the_first);
+    RUN_TEST(test_a_slow_reader_loses_only_what_overflows_the_queue);
+    RUN_TEST(test_discarded_events_are_not_taken);
+    RUN_TEST(test_a_press_is_traced_when_queued_and_every_scan_is_counted);
+    return UNITY_END();
+}
@@ -0,0 +1,265 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_lock_controller.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Exercises the lock controller and the rotary encoder on the host,
+ *      turning the dial through the encoder's pin ISR under virtual time.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <hardware/flash.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "config-store.h"
+#include "keypad.h"
+#include "lock-config.h"
+#include "lock-controller.h"
+#include "lock-bank.h"
+#include "rotary-encoder.h"
+
+#define CONTROL_PERIOD_uS (20000)
+
+// the wiper levels, B then A, that one detent passes through
+static uint8_t const clockwise_detent[] = {0b10, 0b00, 0b01, 0b11};
+static uint8_t const counterclockwise_detent[] = {0b01, 0b00, 0b10, 0b11};
+
+static void step(void) {
+    mock_advance_time_us(CONTROL_PERIOD_uS);
+    control_lock();
+}
+
+static void turn_dial(uint8_t lock, direction_t direction, int detents) {
+    uint8_t const *quadrature = (direction == CLOCKWISE) ? clockwise_detent : counterclockwise_detent;
+    unsigned int const a_wiper_pin = LOCK_A_WIPER_PIN(lock);
+    for (int i = 0; i < detents; i++) {
+        for (int j = 0; j < 4; j++) {
+            mock_advance_time_us(2000);
+            mock_set_input_pins((uint32_t) quadrature[j] << a_wiper_pin, 0x3u << a_wiper_pin);
+        }
+        // the controller takes one detent per step
+        step();
+    }
+}
+
+static void turn(direction_t direction, int detents) {
+    turn_dial(0, direction, detents);
+}
+
+static void press_left_button(void) {
+    mock_cowpi_inputs.left_button_pressed = true;
+    step();
+    mock_cowpi_inputs.left_button_pressed = false;
+    step();
+}
+
+// Dials the default combination, passing each number exactly REQUIRED_PASSES(i) times
+static void dial_default_combination_on(uint8_t lock) {
+    int position = 0;
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        int const number = DEFAULT_COMBINATION_NUMBER(i);
+        direction_t const direction = (i % 2 == 0) ? CLOCKWISE : COUNTERCLOCKWISE;
+        int distance = ((direction == CLOCKWISE) ? number - position : position - number) % DIAL_POSITIONS;
+        distance = (distance + DIAL_POSITIONS - 1) % DIAL_POSITIONS + 1;
+        // after the first number, the first detent of a reversal only moves on to the next number
+        turn_dial(lock, direction, (i > 0) + distance + (REQUIRED_PASSES(i) - 1) * DIAL_POSITIONS);
+        position = number;
+    }
+}
+
+static void dial_default_combination(void) {
+    dial_default_combination_on(0);
+}
+
+// Dials every number of the combination, but none of them right, and presses "enter"
+static void make_a_bad_attempt(void) {
+    turn(CLOCKWISE, 1);
+    for (int i = 1; i < COMBINATION_LENGTH; i++) {
+        turn((i % 2 == 0) ? CLOCKWISE : COUNTERCLOCKWISE, 2);
+    }
+    press_left_button();
+}
+
+void setUp(void) {
+    mock_cowpi_reset();
+    mock_flash_erase_all();
+    discard_lock_checkpoint();
+    initialize_rotary_encoder();
+    initialize_keypad();
+    initialize_lock_controller();
+}
+
+void tearDown(void) {}
+
+void test_starts_locked(void) {
+    TEST_ASSERT_EQUAL_STRING("LOCKED", mock_display_rows[1]);
+    TEST_ASSERT_TRUE(mock_cowpi_outputs.left_led_on);
+    TEST_ASSERT_FALSE(mock_cowpi_outputs.right_led_on);
+}
+
+void test_encoder_counts_each_detent(void) {
+    char buffer[21];
+    turn(CLOCKWISE, 3);
+    turn(COUNTERCLOCKWISE, 2);
+    TEST_ASSERT_EQUAL_STRING("CW: 3 CCW: 2", count_rotations(buffer));
+}
+
+void test_default_combination_opens(void) {
+    dial_default_combination();
+    press_left_button();
+    TEST_ASSERT_EQUAL_STRING("OPEN", mock_display_rows[1]);
+    TEST_ASSERT_FALSE(mock_cowpi_outputs.left_led_on);
+    TEST_ASSERT_TRUE(mock_cowpi_outputs.right_led_on);
+}
+
+void test_both_buttons_relock(void) {
+    dial_default_combination();
+    press_left_button();
+    mock_cowpi_inputs.left_button_pressed = true;
+    mock_cowpi_inputs.right_button_pressed = true;
+    step();
+    TEST_ASSERT_EQUAL_STRING("LOCKED", mock_display_rows[1]);
+}
+
+void test_too_many_bad_attempts_sound_the_alarm(void) {
+    for (int i = 1; i <= MAXIMUM_BAD_ATTEMPTS; i++) {
+        make_a_bad_attempt();
+        // let the feedback blinks finish before the next attempt
+        for (int j = 0; j < 100; j++) {
+            step();
+        }
+    }
+    TEST_ASSERT_EQUAL_STRING("ALERT!", mock_display_rows[1]);
+}
+
+void test_a_bad_attempt_stays_on_the_display(void) {
+    make_a_bad_attempt();
+    for (int j = 0; j < 100; j++) {
+        step();
+    }
+    TEST_ASSERT_EQUAL_STRING("BAD ATTEMPT #1", mock_display_rows[1]);
+    // a warm reset keeps the checkpoint
+    initialize_lock_controller();
+    TEST_ASSERT_EQUAL_STRING("BAD ATTEMPT #1", mock_display_rows[1]);
+}
+
+void test_combination_change_is_stored(void) {
+    dial_default_combination();
+    press_left_button();
+    mock_cowpi_inputs.left_switch_in_right_position = true;
+    mock_cowpi_inputs.right_button_pressed = true;
+    step();
+    mock_cowpi_inputs.right_button_pressed = false;
+    // the new combination 1, 2, 3, ..., then the same again to confirm it
+    uint8_t changed[COMBINATION_LENGTH];
+    char digits[2 * COMBINATION_DIGITS + 1];
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        changed[i] = (uint8_t) ((i + 1) % DIAL_POSITIONS);
+        snprintf(digits + i * DIGITS_PER_NUMBER, DIGITS_PER_NUMBER + 1, "%0*d", DIGITS_PER_NUMBER, changed[i]);
+    }
+    memcpy(digits + COMBINATION_DIGITS, digits, COMBINATION_DIGITS + 1);
+    for (int i = 0; i < 2 * COMBINATION_DIGITS; i++) {
+        mock_cowpi_inputs.key = digits[i];
+        step();
+        mock_cowpi_inputs.key = '\0';
+        step();
+    }
+    mock_cowpi_inputs.left_switch_in_right_position = false;
+    step();
+    uint8_t stored[COMBINATION_LENGTH];
+    TEST_ASSERT_TRUE(load_combination(stored));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(changed, stored, COMBINATION_LENGTH);
+}
+
+#if NUMBER_OF_LOCKS > 1
+void test_each_lock_opens_with_its_own_dial(void) {
+    dial_default_combination_on(1);
+    press_left_button();
+    TEST_ASSERT_EQUAL_STRING("LOCK 2", mock_display_rows[0]);
+    TEST_ASSERT_EQUAL_STRING("OPEN", mock_display_rows[1]);
+    // turning the first lock's dial brings it back to the console, still locked
+    turn_dial(0, CLOCKWISE, 1);
+    TEST_ASSERT_EQUAL_STRING("LOCK 1", mock_display_rows[0]);
+    TEST_ASSERT_EQUAL_STRING("LOCKED", mock_display_rows[1]);
+    TEST_ASSERT_TRUE(mock_cowpi_outputs.left_led_on);
+    TEST_ASSERT_FALSE(mock_cowpi_outputs.right_led_on);
+}
+
+void test_the_buttons_belong_to_the_focused_lock(void) {
+    dial_default_combination_on(0);
+    turn_dial(1, CLOCKWISE, 1);
+    // the first lock is waiting for "enter", but the console now belongs to the second
+    press_left_button();
+    TEST_ASSERT_EQUAL_STRING("LOCK 2", mock_display_rows[0]);
+    TEST_ASSERT_EQUAL_STRING("LOCKED", mock_display_rows[1]);
+    TEST_ASSERT_EQUAL_INT(LOCKED, get_lock_mode());
+}
+
+void test_an_alarmed_lock_keeps_the_console(void) {
+    for (int i = 1; i <= MAXIMUM_BAD_ATTEMPTS; i++) {
+        make_a_bad_attempt();
+        for (int j = 0; j < 100; j++) {
+            step();
+        }
+    }
+    turn_dial(1, CLOCKWISE, 1);
+    TEST_ASSERT_EQUAL_STRING("LOCK 1", mock_display_rows[0]);
+    TEST_ASSERT_EQUAL_STRING("ALERT!", mock_display_rows[1]);
+    TEST_ASSERT_EQUAL_INT(ALARMED, get_lock_mode());
+    TEST_ASSERT_EQUAL_INT(ALARMED, get_bank_mode());
+}
+
+void test_a_lock_off_the_console_keeps_the_bank_awake(void) {
+    dial_default_combination_on(1);
+    press_left_button();
+    turn_dial(0, CLOCKWISE, 1);
+    TEST_ASSERT_EQUAL_INT(LOCKED, get_lock_mode());
+    TEST_ASSERT_EQUAL_INT(UNLOCKED, get_bank_mode());
+}
+
+void test_each_lock_keeps_its_own_combination(void) {
+    uint8_t changed[COMBINATION_LENGTH];
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        changed[i] = (uint8_t) (i + 1);
+    }
+    // enough saves to switch sectors several times, carrying the first lock's record along
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(save_lock_combination(1, changed));
+    }
+    initialize_config_store();
+    uint8_t stored[COMBINATION_LENGTH];
+    TEST_ASSERT_TRUE(load_lock_combination(0, stored));
+    TEST_ASSERT_EQUAL_UINT8(DEFAULT_COMBINATION_NUMBER(0), stored[0]);
+    TEST_ASSERT_TRUE(load_lock_combination(1, stored));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(changed, stored, COMBINATION_LENGTH);
+}
+#endif
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_locked);
+    RUN_TEST(test_encoder_counts_each_detent);
+    RUN_TEST(test_default_combination_opens);
+    RUN_TEST(test_both_buttons_relock);
+    RUN_TEST(test_too_many_bad_attempts_sound_the_alarm);
+    RUN_TEST(test_a_bad_attempt_stays_on_the_display);
+    RUN_TEST(test_combination_change_is_stored);
+#if NUMBER_OF_LOCKS > 1
+    RUN_TEST(test_each_lock_opens_with_its_own_dial);
+    RUN_TEST(test_the_buttons_belong_to_the_focused_lock);
+    RUN_TEST(test_an_alarmed_lock_keeps_the_console);
+    RUN_TEST(test_a_lock_off_the_console_keeps_the_bank_awake);
+    RUN_TEST(test_each_lock_keeps_its_own_combination);
+#endif
+    return UNITY_END();
+}
@@ -0,0 +1,160 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_serial_log.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Checks the serial log's record handling and drop policies on the
+ *      host.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <unity.h>
+#include "serial-log.h"
+#include "telemetry.h"
+
+static char drained[2 * SERIAL_LOG_CAPACITY];
+
+// Takes up to maximum_length bytes from the log, as a port with that much room would
+static size_t drain(size_t maximum_length) {
+    size_t total = 0;
+    while (total < maximum_length) {
+        void const *data;
+        size_t length = serial_log_peek(&data);
+        if (length == 0) {
+            break;
+        }
+        if (length > maximum_length - total) {
+            length = maximum_length - total;
+        }
+        memcpy(drained + total, data, length);
+        serial_log_consume(length);
+        total += length;
+    }
+    drained[total] = '\0';
+    return total;
+}
+
+static void fill_with_records(size_t record_length, unsigned int count) {
+    static char record[SERIAL_LOG_CAPACITY];
+    for (unsigned int i = 0; i < count; i++) {
+        memset(record, 'a' + (i % 26), record_length);
+        serial_log_begin();
+        serial_log_append(record, record_length);
+        serial_log_end();
+    }
+}
+
+void setUp(void) {
+    mock_cowpi_reset();
+    telemetry_clear();
+    clear_serial_log();
+    set_serial_log_policy(SERIAL_LOG_DROP_OLDEST);
+}
+
+void tearDown(void) {}
+
+void test_records_are_sent_in_order_and_only_when_finished(void) {
+    serial_log_line("first");
+    serial_log_begin();
+    serial_log_print("sec");
+    TEST_ASSERT_EQUAL_UINT32(7, drain(100));
+    serial_log_print("ond");
+    serial_log_end();
+    serial_log_line("third");
+    drain(100);
+    TEST_ASSERT_EQUAL_STRING("secondthird\r\n", drained);
+}
+
+void test_drop_newest_keeps_what_is_queued(void) {
+    set_serial_log_policy(SERIAL_LOG_DROP_NEWEST);
+    fill_with_records(SERIAL_LOG_CAPACITY / 4, 4);
+    TEST_ASSERT_FALSE(serial_log_line("late"));
+    TEST_ASSERT_EQUAL_UINT32(1, telemetry_counters[TELEMETRY_DROPPED_LOG_RECORDS]);
+    TEST_ASSERT_EQUAL_UINT32(6, telemetry_counters[TELEMETRY_DROPPED_LOG_BYTES]);
+    TEST_ASSERT_EQUAL_UINT32(SERIAL_LOG_CAPACITY, drain(2 * SERIAL_LOG_CAPACITY));
+    TEST_ASSERT_EQUAL_INT('a', drained[0]);
+}
+
+void test_drop_oldest_never_drops_a_record_that_has_started_to_go_out(void) {
+    fill_with_records(SERIAL_LOG_CAPACITY / 4, 4);
+    drain(4);
+    // the oldest record has started to go out, and the others are queued behind it
+    TEST_ASSERT_FALSE(serial_log_line("late"));
+    drain(SERIAL_LOG_CAPACITY / 4 - 4);
+    fill_with_records(SERIAL_LOG_CAPACITY / 4 + 1, 1);
+    TEST_ASSERT_EQUAL_UINT32(2, telemetry_counters[TELEMETRY_DROPPED_LOG_RECORDS]);
+    TEST_ASSERT_EQUAL_UINT32(6 + SERIAL_LOG_CAPACITY / 4, telemetry_counters[TELEMETRY_DROPPED_LOG_BYTES]);
+    size_t length = drain(2 * SERIAL_LOG_CAPACITY);
+    TEST_ASSERT_EQUAL_UINT32(3 * (SERIAL_LOG_CAPACITY / 4) + 1, length);
+    TEST_ASSERT_EQUAL_INT('c', drained[0]);
+    TEST_ASSERT_EQUAL_INT('d', drained[SERIAL_LOG_CAPACITY / 4]);
+    TEST_ASSERT_EQUAL_INT('a', drained[length - 1]);
+}
+
+void test_a_record_larger_than_the_log_is_dropped_whole(void) {
+    serial_log_line("kept");
+    fill_with_records(SERIAL_LOG_CAPACITY / 2, 1);
+    serial_log_begin();
+    for (int i = 0; i < 3; i++) {
+        static char const chunk[SERIAL_LOG_CAPACITY / 2];
+        serial_log_append(chunk, sizeof(chunk));
+    }
+    TEST_ASSERT_FALSE(serial_log_end());
+    TEST_ASSERT_EQUAL_UINT32(3 * (SERIAL_LOG_CAPACITY / 2) + SERIAL_LOG_CAPACITY / 2 + 6,
+                             telemetry_counters[TELEMETRY_DROPPED_LOG_BYTES]);
+    // dropping the oldest records to make room did not make enough, but the log still works
+    TEST_ASSERT_TRUE(serial_log_line("after"));
+    drain(100);
+    TEST_ASSERT_EQUAL_STRING("after\r\n", drained);
+}
+
+void test_records_wrap_around_the_end_of_the_buffer(void) {
+    fill_with_records(SERIAL_LOG_CAPACITY - 3, 1);
+    drain(SERIAL_LOG_CAPACITY);
+    serial_log_line("wrapped");
+    TEST_ASSERT_EQUAL_UINT32(9, drain(100));
+    TEST_ASSERT_EQUAL_STRING("wrapped\r\n", drained);
+}
+
+void test_the_number_of_records_is_bounded(void) {
+    set_serial_log_policy(SERIAL_LOG_DROP_NEWEST);
+    fill_with_records(1, SERIAL_LOG_MAXIMUM_RECORDS);
+    TEST_ASSERT_FALSE(serial_log_line("x"));
+    set_serial_log_policy(SERIAL_LOG_DROP_OLDEST);
+    TEST_ASSERT_TRUE(serial_log_line("y"));
+    TEST_ASSERT_EQUAL_UINT32(2, telemetry_counters[TELEMETRY_DROPPED_LOG_RECORDS]);
+    size_t length = drain(2 * SERIAL_LOG_CAPACITY);
+    TEST_ASSERT_EQUAL_UINT32(SERIAL_LOG_MAXIMUM_RECORDS - 1 + 3, length);
+    TEST_ASSERT_EQUAL_INT('b', drained[0]);
+}
+
+void test_room_counts_what_is_queued_until_it_is_sent(void) {
+    TEST_ASSERT_EQUAL_UINT32(SERIAL_LOG_CAPACITY, serial_log_room());
+    serial_log_line("queued");
+    TEST_ASSERT_EQUAL_UINT32(SERIAL_LOG_CAPACITY - 8, serial_log_room());
+    drain(3);
+    TEST_ASSERT_EQUAL_UINT32(SERIAL_LOG_CAPACITY - 5, serial_log_room());
+    fill_with_records(1, SERIAL_LOG_MAXIMUM_RECORDS - 1);
+    TEST_ASSERT_EQUAL_UINT32(0, serial_log_room());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_are_sent_in_order_and_only_when_finished);
+    RUN_TEST(test_drop_newest_keeps_what_is_queued);
+    RUN_TEST(test_drop_oldest_never_drops_a_record_that_has_started_to_go_out);
+    RUN_TEST(test_a_record_larger_than_the_log_is_dropped_whole);
+    RUN_TEST(test_records_wrap_around_the_end_of_the_buffer);
+    RUN_TEST(test_the_number_of_records_is_bounded);
+    RUN_TEST(test_room_counts_what_is_queued_until_it_is_sent);
+    return UNITY_END();
+}
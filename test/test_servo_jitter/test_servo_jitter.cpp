@@ -0,0 +1,245 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_servo_jitter.cpp
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief On-target self-test that measures the jitter of the servo signal by
+ *      looping it back into a spare input pin.
+ *
+ * Wire the servo pin (GP22) to the loopback pin (GP18 unless built with
+ * <code>-D SERVO_LOOPBACK_PIN=<i>n</i></code>), then run with
+ * <code>pio test -e servo_jitter</code>. The servo itself may stay connected.
+ *
+ * An edge ISR on the loopback pin timestamps each rising and falling edge
+ * with the RP2040's microsecond timer. Rising edge to rising edge is one
+ * period; rising edge to falling edge is one pulse width. Each is compared
+ * with its nominal length: 20 ms for the period, and the commanded width for
+ * the pulse.
+ *
+ * The signal is captured under each of several background loads:
+ * <ul>
+ * <li> <code>idle</code> -- nothing else runs
+ * <li> <code>encoder</code> -- a timer ISR calls the quadrature ISR every
+ *      <code>ENCODER_LOAD_PERIOD_uS</code>, standing in for a dial that is
+ *      spun as fast as it can be
+ * <li> <code>display</code> -- <code>loop()</code> rewrites and flushes the
+ *      display continuously
+ * <li> <code>encoder_display</code> -- both
+ * </ul>
+ *
+ * Each capture prints one comma-separated line per measurement that starts
+ * with <code>JITTER,</code>; the first such line is the header. Deviations
+ * are signed microseconds from nominal. The edge ISR's own entry latency is
+ * part of every timestamp, so the figures bound the signal's jitter from
+ * above.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <math.h>
+#include <hardware/sync.h>
+#include <unity.h>
+#include "display.h"
+#include "memory-map.h"
+#include "pins.h"
+
+extern "C" {
+#include "interrupt_support.h"
+#include "rotary-encoder.h"
+#include "servomotor.h"
+
+extern void (*const rotary_encoder_isr)(void);
+}
+
+#ifndef SERVO_LOOPBACK_PIN
+#define SERVO_LOOPBACK_PIN (18)
+#endif
+
+#ifndef JITTER_CAPTURE_PERIODS
+#define JITTER_CAPTURE_PERIODS (250)
+#endif
+
+#define ENCODER_LOAD_TIMER (1)
+#define ENCODER_LOAD_PERIOD_uS (250)
+#define SIGNAL_PERIOD_uS (20000)
+
+static volatile cowpi_timer_t *timer = (cowpi_timer_t *) (TIMER_BASE_ADDRESS);
+
+/*
+ * Deviations from nominal. The sums are kept instead of the samples, so the
+ * ISR does a constant amount of work and a capture needs no buffer.
+ */
+struct deviation_statistics {
+    uint32_t count;
+    int32_t minimum;
+    int32_t maximum;
+    int64_t total;
+    uint64_t total_of_squares;
+
+    void add(int32_t deviation) {
+        minimum = (count == 0 || deviation < minimum) ? deviation : minimum;
+        maximum = (count == 0 || deviation > maximum) ? deviation : maximum;
+        total += deviation;
+        total_of_squares += (uint64_t) ((int64_t) deviation * deviation);
+        count++;
+    }
+
+    float mean() const {
+        return count ? (float) total / count : 0.0f;
+    }
+
+    float standard_deviation() const {
+        if (count == 0) {
+            return 0.0f;
+        }
+        float variance = (float) total_of_squares / count - mean() * mean();
+        return (variance > 0.0f) ? sqrtf(variance) : 0.0f;
+    }
+};
+
+static volatile bool is_capturing = false;
+static volatile bool has_rising_edge = false;
+static volatile uint32_t last_rising_edge_us;
+static volatile int32_t nominal_pulse_width_us;
+static volatile uint32_t captured_periods;
+static deviation_statistics periods;
+static deviation_statistics pulse_widths;
+
+static volatile bool encoder_load_is_on = false;
+
+static void handle_loopback_edge() {
+    uint32_t now_us = timer->raw_lower_word;
+    if (!is_capturing) {
+        return;
+    }
+    // the shortest pulse is 500us, far longer than the ISR takes to be entered, so the level still shows the edge
+    if (Pin<SERVO_LOOPBACK_PIN>::is_high()) {
+        if (has_rising_edge) {
+            periods.add((int32_t) (now_us - last_rising_edge_us) - SIGNAL_PERIOD_uS);
+            captured_periods = periods.count;
+        }
+        last_rising_edge_us = now_us;
+        has_rising_edge = true;
+    } else if (has_rising_edge) {
+        pulse_widths.add((int32_t) (now_us - last_rising_edge_us) - nominal_pulse_width_us);
+    }
+}
+
+static void handle_encoder_load() {
+    if (encoder_load_is_on) {
+        rotary_encoder_isr();
+    }
+}
+
+static void print_statistics(char const *load, char const *measurement, int32_t nominal_us,
+                             deviation_statistics const &statistics) {
+    char line[128];
+    snprintf(line, sizeof(line), "JITTER,%s,%s,%lu,%ld,%ld,%.1f,%ld,%.1f,%ld", load, measurement,
+             (unsigned long) statistics.count, (long) nominal_us, (long) statistics.minimum,
+             (double) statistics.mean(), (long) statistics.maximum, (double) statistics.standard_deviation(),
+             (long) (statistics.maximum - statistics.minimum));
+    Serial.println(line);
+}
+
+/*
+ * Captures JITTER_CAPTURE_PERIODS periods of the servo signal while the given
+ * load runs, then prints and checks the statistics.
+ */
+static void capture(char const *load, int32_t pulse_width_us, bool with_encoder, bool with_display) {
+    uint32_t interrupt_status = save_and_disable_interrupts();
+    periods = {};
+    pulse_widths = {};
+    nominal_pulse_width_us = pulse_width_us;
+    captured_periods = 0;
+    has_rising_edge = false;
+    is_capturing = true;
+    encoder_load_is_on = with_encoder;
+    restore_interrupts(interrupt_status);
+
+    // allow a quarter second beyond the nominal length before deciding that the loopback is not wired
+    uint32_t start_us = timer->raw_lower_word;
+    uint32_t timeout_us = JITTER_CAPTURE_PERIODS * SIGNAL_PERIOD_uS + 250000;
+    unsigned int frame = 0;
+    while (captured_periods < JITTER_CAPTURE_PERIODS && timer->raw_lower_word - start_us < timeout_us) {
+        if (with_display) {
+            char text[22];
+            snprintf(text, sizeof(text), "JITTER %s %u", load, frame++);
+            display_string(2, text);
+            refresh_display();
+        }
+    }
+
+    interrupt_status = save_and_disable_interrupts();
+    is_capturing = false;
+    encoder_load_is_on = false;
+    restore_interrupts(interrupt_status);
+    // discard the phantom detents that the encoder load may have produced
+    get_direction();
+
+    print_statistics(load, "period", SIGNAL_PERIOD_uS, periods);
+    print_statistics(load, "pulse_width", pulse_width_us, pulse_widths);
+    TEST_ASSERT_MESSAGE(periods.count > 0, "no edges on the loopback pin; is the servo pin wired to it?");
+    TEST_ASSERT_EQUAL_UINT32(JITTER_CAPTURE_PERIODS, periods.count);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {
+    center_servo();
+}
+
+void test_idle_at_each_position(void) {
+    rotate_full_counterclockwise();
+    capture("idle", 500, false, false);
+    center_servo();
+    capture("idle", 1500, false, false);
+    rotate_full_clockwise();
+    capture("idle", 2500, false, false);
+}
+
+void test_encoder_load(void) {
+    center_servo();
+    capture("encoder", 1500, true, false);
+}
+
+void test_display_load(void) {
+    center_servo();
+    capture("display", 1500, false, true);
+}
+
+void test_encoder_and_display_load(void) {
+    center_servo();
+    capture("encoder_display", 1500, true, true);
+}
+
+void setup() {
+    // let the test runner open the serial port
+    delay(2000);
+    cowpi_setup(0,
+                (cowpi_display_module_t) {.display_module = NO_MODULE},
+                (cowpi_display_module_protocol_t) {.protocol = NO_PROTOCOL}
+               );
+    initialize_display(21);
+    initialize_rotary_encoder();
+    initialize_servo();
+    register_pin_ISR(Pin<SERVO_LOOPBACK_PIN>::mask, handle_loopback_edge);
+    register_periodic_timer_ISR(ENCODER_LOAD_TIMER, ENCODER_LOAD_PERIOD_uS, handle_encoder_load);
+    Serial.println("JITTER,load,measurement,samples,nominal_us,min_dev_us,mean_dev_us,max_dev_us,stddev_us,peak_to_peak_us");
+
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_at_each_position);
+    RUN_TEST(test_encoder_load);
+    RUN_TEST(test_display_load);
+    RUN_TEST(test_encoder_and_display_load);
+    UNITY_END();
+}
+
+void loop() {}
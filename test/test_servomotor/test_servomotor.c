@@ -0,0 +1,82 @@
+/**************************************************************************/
+/**
+ *
+ * @file test_servomotor.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Measures the servo's control signal on the host, with the servo's
+ *      timer ISR fired by the virtual clock.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <unity.h>
+#include "servomotor.h"
+
+#define SERVO_PIN (22)
+#define SIGNAL_PERIOD_uS (20000)
+
+struct signal_measurement {
+    uint32_t high_time_us;
+    uint32_t rising_edges;
+};
+
+// Samples the servo pin every microsecond for one signal period
+static struct signal_measurement measure_signal(void) {
+    struct signal_measurement measurement = {0, 0};
+    bool was_high = mock_sio.output & (1u << SERVO_PIN);
+    for (int i = 0; i < SIGNAL_PERIOD_uS; i++) {
+        mock_advance_time_us(1);
+        bool is_high = mock_sio.output & (1u << SERVO_PIN);
+        measurement.high_time_us += is_high;
+        measurement.rising_edges += (is_high && !was_high);
+        was_high = is_high;
+    }
+    return measurement;
+}
+
+void setUp(void) {
+    mock_cowpi_reset();
+    initialize_servo();
+    // let the first pulse settle
+    mock_advance_time_us(SIGNAL_PERIOD_uS);
+}
+
+void tearDown(void) {}
+
+void test_centered_pulse_is_1500us(void) {
+    struct signal_measurement measurement = measure_signal();
+    TEST_ASSERT_EQUAL_UINT32(1, measurement.rising_edges);
+    TEST_ASSERT_EQUAL_UINT32(1500, measurement.high_time_us);
+}
+
+void test_full_clockwise_pulse_is_2500us(void) {
+    rotate_full_clockwise();
+    measure_signal();
+    struct signal_measurement measurement = measure_signal();
+    TEST_ASSERT_EQUAL_UINT32(1, measurement.rising_edges);
+    TEST_ASSERT_EQUAL_UINT32(2500, measurement.high_time_us);
+}
+
+void test_full_counterclockwise_pulse_is_500us(void) {
+    rotate_full_counterclockwise();
+    measure_signal();
+    struct signal_measurement measurement = measure_signal();
+    TEST_ASSERT_EQUAL_UINT32(1, measurement.rising_edges);
+    TEST_ASSERT_EQUAL_UINT32(500, measurement.high_time_us);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_centered_pulse_is_1500us);
+    RUN_TEST(test_full_clockwise_pulse_is_2500us);
+    RUN_TEST(test_full_counterclockwise_pulse_is_500us);
+    return UNITY_END();
+}
@@ -0,0 +1,229 @@
+/**************************************************************************/
+/**
+ *
+ * @file fuzz-lock-controller.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief libFuzzer target that drives the lock controller with arbitrary
+ *      interleavings of dial turns, buttons, switches, and keypresses.
+ *
+ * Build and run with <code>pio run -e fuzz</code>, then
+ * <code>.pio/build/fuzz/program corpus/</code>. Building with
+ * <code>-D FUZZ_STANDALONE</code> and without <code>-fsanitize=fuzzer</code>
+ * instead gives a program that runs the input files named on its command
+ * line, for reproducing a finding under a debugger or with gcc.
+ *
+ * Each input is a sequence of two-byte steps. In the first byte, bits 0-1
+ * select a dial action (none, one detent clockwise, one detent
+ * counterclockwise, or a half-detent bounce), bits 2-5 are the left button,
+ * right button, left switch, and right switch, and bits 6-7 select how much
+ * virtual time passes before the step (1 ms, 20 ms, 250 ms, or 2.5 s). If
+ * bit 7 of the second byte is set, its low four bits select a key that is
+ * held during the step; a key held for only a 1 ms step is a bounce to the
+ * keypad's debouncing.
+ *
+ * After every step, the harness checks that the combination is valid and
+ * matches the one in flash, and that every transition is one that the
+ * specification allows from the mode the controller was in. A failed check
+ * aborts, so libFuzzer saves the input.
+ *
+ * The virtual time that one <code>control_lock()</code> call takes (flash
+ * stalls, as the mock charges them) is the fuzzing objective: each
+ * power-of-two latency bucket reaches a function of its own, so libFuzzer
+ * treats an input that reaches a slower bucket as new coverage. Defining
+ * <code>FUZZ_STEP_BUDGET_US</code> turns exceeding that latency into a
+ * finding.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <hardware/flash.h>
+#include <stdlib.h>
+#include "config-store.h"
+#include "lock-config.h"
+#include "keypad.h"
+#include "lock-controller.h"
+#include "lock-bank.h"
+#include "rotary-encoder.h"
+#include "trace.h"
+
+#define A_WIPER_PIN (16)
+#define B_WIPER_PIN (17)
+#define WIPER_PINS ((1u << A_WIPER_PIN) | (1u << B_WIPER_PIN))
+
+// the specification's transitions, kept apart from the controller's table so that each checks the other
+#define NOT_ALLOWED (-1)
+static int8_t const allowed_transitions[NUMBER_OF_LOCK_MODES][NUMBER_OF_LOCK_EVENTS] = {
+    [LOCKED] = {NOT_ALLOWED, UNLOCKED, LOCKED, ALARMED, NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED},
+    [UNLOCKED] = {NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, LOCKED, CHANGING, NOT_ALLOWED},
+    [ALARMED] = {NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED},
+    [CHANGING] = {NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, NOT_ALLOWED, UNLOCKED},
+};
+
+static uint32_t const step_delays_us[] = {1000, 20000, 250000, 2500000};
+static char const keys[] = "0123456789ABCD*#";
+
+static uint8_t const clockwise_detent[] = {0b10, 0b00, 0b01, 0b11};
+static uint8_t const counterclockwise_detent[] = {0b01, 0b00, 0b10, 0b11};
+static uint8_t const bounce[] = {0b10, 0b11};
+
+static int tracked_mode;
+static uint64_t worst_step_us = 0;
+
+static void fail(char const *message) {
+    fprintf(stderr, "invariant violated at %llu us: %s\n", (unsigned long long) mock_time_us(), message);
+    abort();
+}
+
+/* ---- stand-in for trace.c: check each transition as it happens ---- */
+
+void trace_record(trace_event_type_t type, uint16_t payload) {
+    if (type != TRACE_TRANSITION) {
+        return;
+    }
+    int from = payload & 0xF;
+    int to = (payload >> 4) & 0xF;
+    int event = payload >> 8;
+    if (from != tracked_mode) {
+        fail("a transition started from a mode other than the current one");
+    }
+    if (from >= NUMBER_OF_LOCK_MODES || event >= NUMBER_OF_LOCK_EVENTS
+        || allowed_transitions[from][event] == NOT_ALLOWED || allowed_transitions[from][event] != to) {
+        fail("a transition that the specification does not allow");
+    }
+    tracked_mode = to;
+}
+
+/* ---- latency buckets ---- */
+
+#define LATENCY_BUCKETS(BUCKET) \
+    BUCKET(0) BUCKET(1) BUCKET(2) BUCKET(3) BUCKET(4) BUCKET(5) BUCKET(6) BUCKET(7) \
+    BUCKET(8) BUCKET(9) BUCKET(10) BUCKET(11) BUCKET(12) BUCKET(13) BUCKET(14) BUCKET(15) \
+    BUCKET(16) BUCKET(17) BUCKET(18) BUCKET(19) BUCKET(20) BUCKET(21) BUCKET(22) BUCKET(23)
+
+// separate functions, rather than cases of one switch, so that the compiler cannot merge them
+#define DEFINE_LATENCY_BUCKET(n) \
+    static __attribute__((noinline)) void reached_latency_bucket_##n(void) { __asm__ volatile(""); }
+#define CALL_LATENCY_BUCKET(n) case n: reached_latency_bucket_##n(); break;
+
+LATENCY_BUCKETS(DEFINE_LATENCY_BUCKET)
+
+static void note_step_latency(uint64_t latency_us) {
+    int bucket = 0;
+    while (bucket < 23 && (latency_us >> bucket) > 1) {
+        bucket++;
+    }
+    switch (bucket) {
+        LATENCY_BUCKETS(CALL_LATENCY_BUCKET)
+        default:
+            break;
+    }
+    if (latency_us > worst_step_us) {
+        worst_step_us = latency_us;
+        fprintf(stderr, "new worst control_lock() step: %llu us\n", (unsigned long long) latency_us);
+    }
+#ifdef FUZZ_STEP_BUDGET_US
+    if (latency_us > FUZZ_STEP_BUDGET_US) {
+        fail("a control_lock() step exceeded FUZZ_STEP_BUDGET_US");
+    }
+#endif
+}
+
+/* ---- the harness ---- */
+
+static void turn_dial(uint8_t const quadrature[], size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        mock_advance_time_us(1000);
+        mock_set_input_pins(((quadrature[i] & 0x1u) << A_WIPER_PIN) | ((quadrature[i] >> 1) << B_WIPER_PIN),
+                            WIPER_PINS);
+    }
+}
+
+static void check_combination(void) {
+    uint8_t const *combination = get_combination();
+    uint8_t stored[COMBINATION_LENGTH];
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        if (combination[i] >= DIAL_POSITIONS) {
+            fail("the combination holds a number that is not on the dial");
+        }
+    }
+    if (!load_combination(stored) || memcmp(stored, combination, COMBINATION_LENGTH) != 0) {
+        fail("the combination in use differs from the one in flash");
+    }
+}
+
+static void start_from_power_on(void) {
+    mock_cowpi_reset();
+    mock_flash_erase_all();
+    discard_lock_checkpoint();
+    initialize_rotary_encoder();
+    initialize_keypad();
+    initialize_lock_controller();
+    tracked_mode = LOCKED;
+    // forget a key still held at the end of the previous input
+    control_lock();
+}
+
+int LLVMFuzzerTestOneInput(uint8_t const *data, size_t size) {
+    start_from_power_on();
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        uint8_t inputs = data[i];
+        uint8_t key = data[i + 1];
+        switch (inputs & 0x3) {
+            case 1:
+                turn_dial(clockwise_detent, sizeof(clockwise_detent));
+                break;
+            case 2:
+                turn_dial(counterclockwise_detent, sizeof(counterclockwise_detent));
+                break;
+            case 3:
+                turn_dial(bounce, sizeof(bounce));
+                break;
+            default:
+                break;
+        }
+        mock_cowpi_inputs.left_button_pressed = inputs & (1 << 2);
+        mock_cowpi_inputs.right_button_pressed = inputs & (1 << 3);
+        mock_cowpi_inputs.left_switch_in_right_position = inputs & (1 << 4);
+        mock_cowpi_inputs.right_switch_in_right_position = inputs & (1 << 5);
+        mock_cowpi_inputs.key = (key & 0x80) ? keys[key & 0xF] : '\0';
+        mock_advance_time_us(step_delays_us[inputs >> 6]);
+
+        uint64_t start_time = mock_time_us();
+        control_lock();
+        note_step_latency(mock_time_us() - start_time);
+        check_combination();
+    }
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+        if (file == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        uint8_t *contents = malloc(length > 0 ? length : 1);
+        size_t bytes_read = fread(contents, 1, length, file);
+        fclose(file);
+        LLVMFuzzerTestOneInput(contents, bytes_read);
+        free(contents);
+    }
+    printf("%d inputs, worst control_lock() step: %llu us\n", argc - 1, (unsigned long long) worst_step_us);
+    return 0;
+}
+
+#endif //FUZZ_STANDALONE
@@ -0,0 +1,5 @@
+# libFuzzer ships with clang, not gcc, and the sanitizers must be linked too
+Import("env")
+
+env.Replace(CC="clang", CXX="clang++", LINK="clang")
+env.Append(LINKFLAGS=["-fsanitize=fuzzer,address,undefined"])
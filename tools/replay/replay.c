@@ -0,0 +1,464 @@
+/**************************************************************************/
+/**
+ *
+ * @file replay.c
+ *
+ * @author Luciano Carvalho
+ * @author Lucas Coelho
+ *
+ * @brief Replays a recorded or synthetic input trace through the lock
+ *      controller on the host, under a virtual clock.
+ *
+ * Usage: <code>replay [--quiet] [--repeat N] [--step-us N] [--tail-us N]
+ * [--combination A-B-C] [--mode locked|unlocked|alarmed] [--bad-tries N]
+ * FILE</code>
+ *
+ * <code>FILE</code> is either a binary capture of the Serial port holding the
+ * frame sent in response to the <code>T</code> diagnostic command, or a text
+ * file with one event per line: a timestamp in microseconds, an event type
+ * (<code>quadrature</code>, <code>key</code>, or <code>inputs</code>), and a
+ * payload, as in <code>125000 key 5</code>. Blank lines and lines starting
+ * with <code>#</code> are ignored.
+ *
+ * The controller is stepped every <code>--step-us</code> microseconds of
+ * virtual time (default 20000, about one pass of <code>loop()</code> on the
+ * board), and for <code>--tail-us</code> microseconds after the last event
+ * (default 2000000) so that timed flows can finish. Quadrature events drive
+ * the encoder's ISR as they occur, exactly as pin changes would.
+ *
+ * The output is the sequence of transitions, display writes, servo commands,
+ * and LED changes, each stamped with its virtual time. If the input is a
+ * recorded trace, its recorded transitions are compared against the replayed
+ * ones. With <code>--repeat</code>, the trace is replayed that many times and
+ * the host's controller step rate is reported.
+ *
+ * A trace holds inputs, not the controller's state, so by default the replay
+ * starts the first lock as it is at first power-on: the default combination,
+ * <code>LOCKED</code>, and no bad attempts. A trace from a unit whose
+ * combination was changed, or whose trace buffer has wrapped, reproduces the
+ * recording only if <code>--combination</code>, <code>--mode</code>, and
+ * <code>--bad-tries</code> give the state that the unit was in when the trace
+ * begins; the controller then resumes from that state as it would after a
+ * warm reset. A combination only partly dialed when the trace begins cannot
+ * be given, so such a trace should be cut to start with the dial at rest.
+ *
+ ******************************************************************************/
+
+/*
+ * ComboLock GroupLab assignment and starter code (c) 2022-24 Christopher A. Bohn
+ * ComboLock solution (c) the above-named students
+ */
+
+#include <CowPi.h>
+#include <hardware/flash.h>
+#include <hardware/sync.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lock-config.h"
+#include "crc32.h"
+#include "keypad.h"
+#include "lock-controller.h"
+#include "lock-bank.h"
+#include "rotary-encoder.h"
+#include "servomotor.h"
+#include "servo-bank.h"
+#include "trace.h"
+
+static char const *const mode_names[NUMBER_OF_LOCK_MODES] = {
+    [LOCKED] = "LOCKED", [UNLOCKED] = "UNLOCKED", [ALARMED] = "ALARMED", [CHANGING] = "CHANGING"
+};
+static char const *const event_names[NUMBER_OF_LOCK_EVENTS] = {
+    [NO_EVENT] = "NO_EVENT", [ATTEMPT_ACCEPTED] = "ATTEMPT_ACCEPTED", [ATTEMPT_REJECTED] = "ATTEMPT_REJECTED",
+    [TOO_MANY_ATTEMPTS] = "TOO_MANY_ATTEMPTS", [RELOCK_REQUESTED] = "RELOCK_REQUESTED",
+    [CHANGE_REQUESTED] = "CHANGE_REQUESTED", [CHANGE_FINISHED] = "CHANGE_FINISHED"
+};
+
+#define QUADRATURE_A_PIN (16)
+#define QUADRATURE_B_PIN (17)
+
+// long enough for the keypad's scan to debounce a replayed key
+#define KEY_HOLD_US (2 * KEYPAD_DEBOUNCE_SCANS * KEYPAD_SCAN_PERIOD_uS)
+
+struct replay_event {
+    uint64_t timestamp_us;
+    uint8_t type;
+    uint16_t payload;
+};
+
+static struct replay_event *events = NULL;
+static size_t number_of_events = 0;
+static size_t event_capacity = 0;
+
+static bool quiet = false;
+static char shown_rows[MOCK_DISPLAY_ROWS][MOCK_DISPLAY_COLUMNS + 1];
+static uint16_t *replayed_transitions = NULL;
+static size_t number_of_replayed_transitions = 0;
+static size_t transition_capacity = 0;
+static unsigned long steps = 0;
+static uint64_t key_release_us = 0;
+
+// the state that the recorded unit was in when the trace begins
+static bool has_starting_state = false;
+static uint8_t starting_combination[COMBINATION_LENGTH];
+static lock_mode_t starting_mode = LOCKED;
+static uint8_t starting_bad_tries = 0;
+
+/* ---- stand-ins for the modules that CowPiMock does not cover ---- */
+
+static void report_servo(char const *position) {
+    if (!quiet) {
+        printf("%10llu servo %s\n", (unsigned long long) mock_time_us(), position);
+    }
+}
+
+void initialize_servo() {
+    center_servo();
+}
+
+void center_servo() {
+    report_servo("center");
+}
+
+void rotate_full_clockwise() {
+    report_servo("clockwise");
+}
+
+void rotate_full_counterclockwise() {
+    report_servo("counterclockwise");
+}
+
+void center_servo_of(uint8_t lock) {
+    center_servo();
+}
+
+void rotate_full_clockwise_of(uint8_t lock) {
+    rotate_full_clockwise();
+}
+
+void rotate_full_counterclockwise_of(uint8_t lock) {
+    rotate_full_counterclockwise();
+}
+
+void trace_record(trace_event_type_t type, uint16_t payload) {
+    if (type != TRACE_TRANSITION) {
+        return;
+    }
+    if (number_of_replayed_transitions == transition_capacity) {
+        transition_capacity = transition_capacity ? 2 * transition_capacity : 64;
+        replayed_transitions = realloc(replayed_transitions, transition_capacity * sizeof(uint16_t));
+    }
+    replayed_transitions[number_of_replayed_transitions++] = payload;
+    if (!quiet) {
+        printf("%10llu transition %s -> %s (%s)\n", (unsigned long long) mock_time_us(),
+               mode_names[payload & 0xF], mode_names[(payload >> 4) & 0xF], event_names[(payload >> 8) & 0xF]);
+    }
+}
+
+/* ---- trace loading ---- */
+
+static void append_event(uint64_t timestamp_us, uint8_t type, uint16_t payload) {
+    if (number_of_events == event_capacity) {
+        event_capacity = event_capacity ? 2 * event_capacity : 256;
+        events = realloc(events, event_capacity * sizeof(struct replay_event));
+    }
+    events[number_of_events++] = (struct replay_event) {
+            .timestamp_us = timestamp_us, .type = type, .payload = payload
+    };
+}
+
+static uint32_t read_le(uint8_t const *bytes, int length) {
+    uint32_t value = 0;
+    for (int i = length - 1; i >= 0; i--) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+static bool load_binary_trace(uint8_t const *contents, size_t length) {
+    bool found_frame = false;
+    for (size_t i = 0; i + 5 <= length; i++) {
+        if (contents[i] != 0xA5 || contents[i + 1] != 0x5A || contents[i + 2] != 'T') {
+            continue;
+        }
+        uint16_t payload_length = read_le(contents + i + 3, 2);
+        if (i + 5 + payload_length + 4 > length) {
+            break;
+        }
+        uint8_t const *payload = contents + i + 5;
+        uint32_t crc = read_le(payload + payload_length, 4);
+        if (crc != crc32(contents + i + 2, 3 + payload_length)) {
+            fprintf(stderr, "skipping trace frame with bad CRC at byte %zu\n", i);
+            continue;
+        }
+        uint8_t event_size = payload[1];
+        uint16_t count = read_le(payload + 6, 2);
+        // the device's 32-bit microsecond counter wraps every 71 minutes; unwrap it
+        uint64_t epoch = 0;
+        uint32_t previous = 0;
+        for (uint16_t j = 0; j < count; j++) {
+            uint8_t const *event = payload + 8 + j * event_size;
+            uint32_t timestamp = read_le(event, 4);
+            if (j > 0 && timestamp < previous) {
+                epoch += 1ULL << 32;
+            }
+            previous = timestamp;
+            append_event(epoch + timestamp, event[4], read_le(event + 6, 2));
+        }
+        found_frame = true;
+        i += 5 + payload_length + 4 - 1;
+    }
+    return found_frame;
+}
+
+static bool load_text_trace(char *contents) {
+    int line_number = 0;
+    for (char *line = strtok(contents, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+        line_number++;
+        while (*line == ' ' || *line == '\t') line++;
+        if (*line == '\0' || *line == '#' || *line == '\r') {
+            continue;
+        }
+        unsigned long long timestamp;
+        char type_name[16];
+        char payload_text[16];
+        if (sscanf(line, "%llu %15s %15s", &timestamp, type_name, payload_text) != 3) {
+            fprintf(stderr, "line %d: expected <time_us> <type> <payload>\n", line_number);
+            return false;
+        }
+        if (!strcmp(type_name, "quadrature")) {
+            append_event(timestamp, TRACE_QUADRATURE, (uint16_t) strtoul(payload_text, NULL, 0));
+        } else if (!strcmp(type_name, "key")) {
+            append_event(timestamp, TRACE_KEYPRESS, (uint8_t) payload_text[0]);
+        } else if (!strcmp(type_name, "inputs")) {
+            append_event(timestamp, TRACE_INPUTS, (uint16_t) strtoul(payload_text, NULL, 0));
+        } else {
+            fprintf(stderr, "line %d: unknown event type \"%s\"\n", line_number, type_name);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool load_trace(char const *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        perror(filename);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *contents = malloc(length + 1);
+    size_t bytes_read = fread(contents, 1, length, file);
+    fclose(file);
+    contents[bytes_read] = '\0';
+    bool loaded = load_binary_trace((uint8_t const *) contents, bytes_read) || load_text_trace(contents);
+    free(contents);
+    return loaded;
+}
+
+/* ---- replay ---- */
+
+static void report_leds(void) {
+    static bool left_led_on = false;
+    static bool right_led_on = false;
+    if (mock_cowpi_outputs.left_led_on != left_led_on || mock_cowpi_outputs.right_led_on != right_led_on) {
+        left_led_on = mock_cowpi_outputs.left_led_on;
+        right_led_on = mock_cowpi_outputs.right_led_on;
+        if (!quiet) {
+            printf("%10llu leds left=%s right=%s\n", (unsigned long long) mock_time_us(),
+                   left_led_on ? "on" : "off", right_led_on ? "on" : "off");
+        }
+    }
+}
+
+static void report_display(void) {
+    for (int row = 0; row < MOCK_DISPLAY_ROWS; row++) {
+        if (strcmp(shown_rows[row], mock_display_rows[row]) != 0) {
+            strcpy(shown_rows[row], mock_display_rows[row]);
+            if (!quiet) {
+                printf("%10llu display %d \"%s\"\n", (unsigned long long) mock_time_us(), row, shown_rows[row]);
+            }
+        }
+    }
+}
+
+static void step_controller(void) {
+    control_lock();
+    steps++;
+    report_display();
+    report_leds();
+    if (mock_time_us() >= key_release_us) {
+        mock_cowpi_inputs.key = '\0';
+    }
+}
+
+static void apply_event(struct replay_event const *event) {
+    switch (event->type) {
+        case TRACE_QUADRATURE:
+            if (event->payload >> 2) {
+                // only the first lock's encoder is wired up here
+                break;
+            }
+            mock_set_input_pins(((event->payload & 0x1u) << QUADRATURE_A_PIN)
+                                | (((event->payload >> 1) & 0x1u) << QUADRATURE_B_PIN),
+                                (1u << QUADRATURE_A_PIN) | (1u << QUADRATURE_B_PIN));
+            break;
+        case TRACE_KEYPRESS:
+            // held through the keypad's debouncing, and then until the controller's next step
+            mock_cowpi_inputs.key = (char) event->payload;
+            key_release_us = event->timestamp_us + KEY_HOLD_US;
+            break;
+        case TRACE_INPUTS:
+            mock_cowpi_inputs.left_button_pressed = event->payload & TRACE_INPUT_LEFT_BUTTON_PRESSED;
+            mock_cowpi_inputs.right_button_pressed = event->payload & TRACE_INPUT_RIGHT_BUTTON_PRESSED;
+            mock_cowpi_inputs.left_switch_in_right_position = event->payload & TRACE_INPUT_LEFT_SWITCH_RIGHT;
+            mock_cowpi_inputs.right_switch_in_right_position = event->payload & TRACE_INPUT_RIGHT_SWITCH_RIGHT;
+            break;
+        default:
+            // detents and transitions are outputs of the recorded run, not inputs to this one
+            break;
+    }
+}
+
+static void replay(uint64_t step_us, uint64_t tail_us) {
+    uint64_t start_time = (number_of_events > 0) ? events[0].timestamp_us : 0;
+    mock_cowpi_reset();
+    mock_flash_erase_all();
+    memset(shown_rows, 0, sizeof(shown_rows));
+    number_of_replayed_transitions = 0;
+    key_release_us = 0;
+    mock_set_time_us(start_time);
+    discard_lock_checkpoint();
+    initialize_rotary_encoder();
+    initialize_keypad();
+    initialize_lock_controller();
+    if (has_starting_state) {
+        checkpoint_lock_state(0, starting_combination, starting_mode, starting_bad_tries);
+        initialize_lock_controller();
+    }
+    report_display();
+    report_leds();
+
+    uint64_t next_step = start_time;
+    for (size_t i = 0; i < number_of_events; i++) {
+        while (next_step <= events[i].timestamp_us) {
+            mock_run_until_us(next_step);
+            step_controller();
+            next_step += step_us;
+        }
+        mock_run_until_us(events[i].timestamp_us);
+        apply_event(&events[i]);
+    }
+    uint64_t end_time = ((number_of_events > 0) ? events[number_of_events - 1].timestamp_us : start_time) + tail_us;
+    while (next_step <= end_time) {
+        mock_run_until_us(next_step);
+        step_controller();
+        next_step += step_us;
+    }
+}
+
+static void compare_transitions(void) {
+    size_t recorded = 0;
+    size_t replayed = 0;
+    for (size_t i = 0; i < number_of_events; i++) {
+        if (events[i].type != TRACE_TRANSITION) {
+            continue;
+        }
+        if (replayed >= number_of_replayed_transitions || replayed_transitions[replayed] != events[i].payload) {
+            printf("replay diverges from the recording at recorded transition %zu (t=%llu)\n",
+                   recorded, (unsigned long long) events[i].timestamp_us);
+            return;
+        }
+        recorded++;
+        replayed++;
+    }
+    if (recorded > 0) {
+        printf("replay matches all %zu recorded transitions\n", recorded);
+    }
+}
+
+static bool parse_combination(char const *text) {
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        char *end;
+        unsigned long number = strtoul(text, &end, 10);
+        if (end == text || number >= DIAL_POSITIONS || *end != ((i < COMBINATION_LENGTH - 1) ? '-' : '\0')) {
+            return false;
+        }
+        starting_combination[i] = (uint8_t) number;
+        text = end + 1;
+    }
+    return true;
+}
+
+static bool parse_mode(char const *text) {
+    static char const *const names[] = {[LOCKED] = "locked", [UNLOCKED] = "unlocked", [ALARMED] = "alarmed"};
+    for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (!strcmp(text, names[i])) {
+            starting_mode = (lock_mode_t) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long repetitions = 1;
+    uint64_t step_us = 20000;
+    uint64_t tail_us = 2000000;
+    char const *filename = NULL;
+    bool is_valid = true;
+    for (int i = 0; i < COMBINATION_LENGTH; i++) {
+        starting_combination[i] = DEFAULT_COMBINATION_NUMBER(i);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--quiet")) {
+            quiet = true;
+        } else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+            repetitions = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--step-us") && i + 1 < argc) {
+            step_us = strtoull(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--tail-us") && i + 1 < argc) {
+            tail_us = strtoull(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--combination") && i + 1 < argc) {
+            is_valid = is_valid && parse_combination(argv[++i]);
+            has_starting_state = true;
+        } else if (!strcmp(argv[i], "--mode") && i + 1 < argc) {
+            is_valid = is_valid && parse_mode(argv[++i]);
+            has_starting_state = true;
+        } else if (!strcmp(argv[i], "--bad-tries") && i + 1 < argc) {
+            starting_bad_tries = (uint8_t) strtoul(argv[++i], NULL, 0);
+            has_starting_state = true;
+        } else {
+            filename = argv[i];
+        }
+    }
+    if (filename == NULL || repetitions == 0 || step_us == 0 || !is_valid) {
+        fprintf(stderr, "usage: %s [--quiet] [--repeat N] [--step-us N] [--tail-us N]\n"
+                        "       [--combination A-B-C] [--mode locked|unlocked|alarmed] [--bad-tries N] FILE\n"
+                        "By default the lock starts as at first power-on: the default combination, locked,\n"
+                        "with no bad attempts. Give the recorded unit's state when the trace begins if it\n"
+                        "differs; a partly dialed combination cannot be given.\n", argv[0]);
+        return 2;
+    }
+    if (!load_trace(filename)) {
+        return 1;
+    }
+
+    struct timespec start, finish;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long i = 0; i < repetitions; i++) {
+        replay(step_us, tail_us);
+        // only the first run's output is interesting
+        quiet = true;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    compare_transitions();
+    if (repetitions > 1) {
+        double seconds = (finish.tv_sec - start.tv_sec) + (finish.tv_nsec - start.tv_nsec) / 1e9;
+        printf("%lu controller steps in %.3f s: %.0f steps/s\n", steps, seconds, steps / seconds);
+    }
+    return 0;
+}